@@ -6,10 +6,77 @@
  */
 
 #include "lfu_cache.h"
+#include <atomic>
 #include <chrono>
+#include <filesystem>
 #include <random>
+#include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts copies and moves so tests can check that a path never copies the payload
+struct CopyCountingValue {
+    static inline int copies = 0;
+    std::vector<char> buffer;
+    
+    CopyCountingValue() = default;
+    explicit CopyCountingValue(size_t size) : buffer(size) {}
+    CopyCountingValue(const CopyCountingValue& other) : buffer(other.buffer) { ++copies; }
+    CopyCountingValue(CopyCountingValue&&) noexcept = default;
+    CopyCountingValue& operator=(const CopyCountingValue& other) { buffer = other.buffer; ++copies; return *this; }
+    CopyCountingValue& operator=(CopyCountingValue&&) noexcept = default;
+};
+
+// Key with no operator==: two tickets are the same entry when their ids match
+struct TicketKey {
+    int id;
+    int revision;
+};
+
+struct TicketHash {
+    size_t operator()(const TicketKey& key) const noexcept { return std::hash<int>{}(key.id); }
+};
+
+struct TicketEqual {
+    bool operator()(const TicketKey& a, const TicketKey& b) const noexcept { return a.id == b.id; }
+};
+
+// Eviction listener that recycles evicted buffers into a pool
+struct RecyclingListener {
+    static constexpr bool ENABLED = true;
+    std::vector<int> evictedKeys;
+    std::vector<CopyCountingValue> pool;
+    
+    void OnEvict(int&& key, CopyCountingValue&& value) noexcept {
+        evictedKeys.push_back(key);
+        pool.push_back(std::move(value));
+    }
+};
+
+// Weighs string values by their length
+struct StringSizeWeigher {
+    static constexpr bool ENABLED = true;
+    
+    size_t operator()(int, const std::string& value) const noexcept { return value.size(); }
+};
+
+// Clock the tests advance by hand, for deterministic expiry
+struct ManualClock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<ManualClock>;
+    static constexpr bool is_steady = true;
+    static inline time_point current{};
+    
+    static time_point now() noexcept { return current; }
+};
 
 // Test runner for validation
 class OptimizedTestRunner {
@@ -36,82 +103,596 @@ public:
     }
 };
 
+// Value type without a default constructor; nodes are constructed only when used
+struct ExplicitValue {
+    explicit ExplicitValue(int v) : value(v) {}
+    int value;
+};
+
 // Validate that optimized cache has same functionality as original
 void runFunctionalValidation() {
     OptimizedTestRunner test;
     
     std::cout << "========== FUNCTIONAL VALIDATION ==========\n";
     
-    // Test basic functionality
-    LFUCache<int, std::string, 10> optimizedCache;
+    // Test basic functionality (capacity 3)
+    LFUCache<int, std::string, 3> optimizedCache;
     
     // Test basic put/get
-    optimizedCache.put(1, "one");
-    optimizedCache.put(2, "two");
-    optimizedCache.put(3, "three");
+    optimizedCache.Put(1, "one");
+    optimizedCache.Put(2, "two");
+    optimizedCache.Put(3, "three");
     
-    test.test(optimizedCache.getOrThrow(1) == "one", "Basic get operation");
-    test.test(optimizedCache.getOrThrow(2) == "two", "Basic get operation 2");
-    test.test(optimizedCache.size() == 3, "Cache size after insertion");
+    test.test(optimizedCache.GetOrThrow(1) == "one", "Basic get operation");
+    test.test(optimizedCache.GetOrThrow(2) == "two", "Basic get operation 2");
+    test.test(optimizedCache.Size() == 3, "Cache size after insertion");
     
     // Test capacity limit and LFU eviction
-    optimizedCache.put(4, "four");
-    test.test(optimizedCache.size() == 3, "Cache size after exceeding capacity");
-    test.test(!optimizedCache.contains(3), "LFU eviction - key 3 should be evicted");
-    test.test(optimizedCache.contains(4), "New key should be present");
+    optimizedCache.Put(4, "four");
+    test.test(optimizedCache.Size() == 3, "Cache size after exceeding capacity");
+    test.test(!optimizedCache.Contains(3), "LFU eviction - key 3 should be evicted");
+    test.test(optimizedCache.Contains(4), "New key should be present");
     
     // Test frequency-based eviction
-    optimizedCache.clear();
-    optimizedCache.put(1, "one");
-    optimizedCache.put(2, "two");
-    optimizedCache.put(3, "three");
+    optimizedCache.Clear();
+    optimizedCache.Put(1, "one");
+    optimizedCache.Put(2, "two");
+    optimizedCache.Put(3, "three");
     
     // Access key 1 twice, key 2 once
-    optimizedCache.get(1);
-    optimizedCache.get(2);
-    optimizedCache.get(1);
+    optimizedCache.Get(1);
+    optimizedCache.Get(2);
+    optimizedCache.Get(1);
     
-    optimizedCache.put(4, "four");
-    test.test(!optimizedCache.contains(3), "LFU eviction - key 3 evicted (lowest frequency)");
-    test.test(optimizedCache.contains(1), "Key 1 retained (highest frequency)");
-    test.test(optimizedCache.contains(2), "Key 2 retained");
-    test.test(optimizedCache.contains(4), "Key 4 added");
+    optimizedCache.Put(4, "four");
+    test.test(!optimizedCache.Contains(3), "LFU eviction - key 3 evicted (lowest frequency)");
+    test.test(optimizedCache.Contains(1), "Key 1 retained (highest frequency)");
+    test.test(optimizedCache.Contains(2), "Key 2 retained");
+    test.test(optimizedCache.Contains(4), "Key 4 added");
     
     // Test update existing key
-    optimizedCache.put(1, "ONE");
-    test.test(optimizedCache.getOrThrow(1) == "ONE", "Update existing key");
+    optimizedCache.Put(1, "ONE");
+    test.test(optimizedCache.GetOrThrow(1) == "ONE", "Update existing key");
     
     // Test getOrDefault
-    test.test(optimizedCache.getOrDefault(99, "default") == "default", "getOrDefault for missing key");
-    test.test(optimizedCache.getOrDefault(1, "default") == "ONE", "getOrDefault for existing key");
+    test.test(optimizedCache.GetOrDefault(99, "default") == "default", "getOrDefault for missing key");
+    test.test(optimizedCache.GetOrDefault(1, "default") == "ONE", "getOrDefault for existing key");
     
     // Test template type aliases
     LFUCache<int, int, 5> intCache;
-    intCache.put(1, 100);
-    intCache.put(2, 200);
-    test.test(intCache.getOrThrow(1) == 100, "LFUCache<int, int> functionality");
+    intCache.Put(1, 100);
+    intCache.Put(2, 200);
+    test.test(intCache.GetOrThrow(1) == 100, "LFUCache<int, int> functionality");
     
     LFUCache<std::string, std::string, 5> stringCache;
-    stringCache.put("key1", "value1");
-    stringCache.put("key2", "value2");
-    test.test(stringCache.getOrThrow("key1") == "value1", "LFUCache<string, string> functionality");
-    
+    stringCache.Put("key1", "value1");
+    stringCache.Put("key2", "value2");
+    test.test(stringCache.GetOrThrow("key1") == "value1", "LFUCache<string, string> functionality");
+    
+    // Test runtime-capacity cache (same API, capacity chosen at construction)
+    DynamicLFUCache<int, std::string> dynamicCache(3);
+    dynamicCache.Put(1, "one");
+    dynamicCache.Put(2, "two");
+    dynamicCache.Put(3, "three");
+    dynamicCache.Get(1);
+    dynamicCache.Put(4, "four");
+    test.test(dynamicCache.Capacity() == 3, "DynamicLFUCache - runtime capacity");
+    test.test(dynamicCache.Size() == 3 && !dynamicCache.Contains(2), "DynamicLFUCache - LFU eviction at runtime capacity");
+    test.test(dynamicCache.GetOrDefault(1, "missing") == "one", "DynamicLFUCache - getOrDefault for existing key");
+    
+    bool invalidCapacityThrown = false;
+    try {
+        DynamicLFUCache<int, int> emptyCache(0);
+    } catch (const std::invalid_argument&) {
+        invalidCapacityThrown = true;
+    }
+    test.test(invalidCapacityThrown, "DynamicLFUCache - zero capacity rejected at construction");
+    
+    // Test lazily constructed node storage (no default-constructed Keys/Values)
+    LFUCache<int, ExplicitValue, 4> explicitCache;
+    explicitCache.Put(1, ExplicitValue(10));
+    test.test(explicitCache.GetOrDefault(1, ExplicitValue(0)).value == 10, "Lazy node storage - non-default-constructible values");
+    
+    // Test sharded thread-safe cache (same hybrid API)
+    auto shardedCache = std::make_unique<ShardedLFUCache<int, int, 64, 4>>();
+    shardedCache->Put(1, 100);
+    shardedCache->Put(2, 200);
+    test.test(shardedCache->Get(1) == 100 && shardedCache->GetOrDefault(3, -1) == -1, "ShardedLFUCache - basic get/put");
+    test.test(shardedCache->Capacity() == 64, "ShardedLFUCache - capacity split across shards");
+    
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&shardedCache, t] {
+            for (int i = 0; i < 10000; ++i) {
+                int key = (i * 7 + t) % 256;
+                shardedCache->Put(key, key);
+                shardedCache->Get(key);
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    test.test(shardedCache->Size() <= 64, "ShardedLFUCache - concurrent puts respect capacity");
+    
+    // Test GetOrCompute: one loader call per key, and concurrent misses coalesce into one load
+    LFUCache<int, int, 10> computeCache;
+    int localLoads = 0;
+    auto square = [&localLoads](int key) { ++localLoads; return key * key; };
+    test.test(computeCache.GetOrCompute(7, square) == 49 && computeCache.GetOrCompute(7, square) == 49
+              && localLoads == 1, "GetOrCompute - miss loads once, hit reuses the cached value");
+    
+    std::atomic<int> sharedLoads{0};
+    std::atomic<int> wrongResults{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 8; ++t) {
+        readers.emplace_back([&] {
+            int value = shardedCache->GetOrCompute(1000, [&sharedLoads](int key) {
+                ++sharedLoads;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                return key + 1;
+            });
+            wrongResults += value == 1001 ? 0 : 1;
+        });
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    test.test(sharedLoads == 1 && wrongResults == 0, "ShardedLFUCache::GetOrCompute - concurrent misses share one load");
+    
+    ShardedLFUCache<TicketKey, int, 16, 4, TicketHash, LFUAlwaysAdmit, TicketEqual> ticketCache;
+    std::atomic<int> ticketLoads{0};
+    std::vector<std::thread> ticketReaders;
+    for (int t = 0; t < 4; ++t) {
+        ticketReaders.emplace_back([&, t] {
+            ticketCache.GetOrCompute(TicketKey{7, t}, [&ticketLoads](const TicketKey& key) {
+                ++ticketLoads;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                return key.id;
+            });
+        });
+    }
+    for (std::thread& reader : ticketReaders) {
+        reader.join();
+    }
+    test.test(ticketLoads == 1 && ticketCache.Get(TicketKey{7, 9}) == 7,
+              "ShardedLFUCache::GetOrCompute - in-flight loads matched with KeyEqual");
+    
+    // Test W-TinyLFU admission: a scan of unseen keys must not displace a hot working set
+    LFUCache<int, int, 100, std::hash<int>, TinyLFUAdmission<>> admissionCache;
+    for (int round = 0; round < 5; ++round) {
+        for (int key = 0; key < 90; ++key) {
+            admissionCache.Put(key, key);
+        }
+    }
+    for (int key = 1000; key < 2000; ++key) {
+        admissionCache.Put(key, key);
+    }
+    int hotSurvivors = 0;
+    for (int key = 0; key < 90; ++key) {
+        hotSurvivors += admissionCache.Contains(key) ? 1 : 0;
+    }
+    test.test(hotSurvivors == 90 && admissionCache.Size() == 100, "TinyLFU admission - hot keys survive a cold scan");
+    
+    // Test frequency aging: a once-hot key is eventually evicted by a stream of new keys
+    LFUCache<int, int, 2> plainCache;
+    LFUCache<int, int, 2> agedCache;
+    agedCache.SetDynamicAging(true);
+    plainCache.Put(1, 1);
+    agedCache.Put(1, 1);
+    for (int i = 0; i < 5; ++i) {
+        plainCache.Get(1);
+        agedCache.Get(1);
+    }
+    for (int key = 2; key <= 20; ++key) {
+        plainCache.Put(key, key);
+        agedCache.Put(key, key);
+    }
+    test.test(plainCache.Contains(1) && !agedCache.Contains(1), "Dynamic aging - stale hot key no longer pins the cache");
+    
+    // Test batched MultiPut/MultiGet (same semantics as the scalar loop)
+    LFUCache<int, int, 100> batchCache;
+    std::vector<int> batchKeys = {1, 2, 3, 4, 2};
+    std::vector<int> batchValues = {10, 20, 30, 40, 25};
+    batchCache.MultiPut(batchKeys, batchValues);
+    std::vector<int> lookupKeys = {2, 5, 4};
+    std::vector<int> lookupValues(3, -1);
+    bool lookupFound[3] = {};
+    batchCache.MultiGet(lookupKeys, lookupValues, lookupFound);
+    test.test(lookupFound[0] && lookupValues[0] == 25 && !lookupFound[1] && lookupValues[1] == -1
+              && lookupFound[2] && lookupValues[2] == 40, "MultiGet/MultiPut - batched results match scalar semantics");
+    
+    // Test single-probe TryGet: a miss is distinguishable from a default-constructed value
+    LFUCache<int, int, 10> tryCache;
+    tryCache.Put(1, 0);
+    int tryValue = -1;
+    bool tryHit = tryCache.TryGet(1, tryValue);
+    int missValue = -1;
+    bool tryMiss = !tryCache.TryGet(2, missValue);
+    test.test(tryHit && tryValue == 0 && tryMiss && missValue == -1 && tryCache.TryGet(1) == std::optional<int>(0)
+              && !tryCache.TryGet(2).has_value(), "TryGet - single lookup distinguishes hits from misses");
+    
+    // Test heterogeneous lookup: string_view and literal keys without a temporary std::string
+    LFUCache<std::string, int, 10, LFUStringHash, LFUAlwaysAdmit, std::equal_to<>> viewKeyCache;
+    std::string longKey(40, 'k');  // Longer than any small-string buffer
+    viewKeyCache.Put(longKey, 1);
+    viewKeyCache.Put("short", 2);
+    std::string_view parsedKey(longKey);
+    int viewValue = 0;
+    test.test(viewKeyCache.TryGet(parsedKey, viewValue) && viewValue == 1 && viewKeyCache.Get("short") == 2
+              && viewKeyCache.Contains(std::string_view("short")) && !viewKeyCache.Contains("missing")
+              && viewKeyCache.GetOrDefault(std::string_view("missing"), -1) == -1,
+              "Transparent lookup - string_view and literal keys");
+    
+    // Test precomputed-hash entry points against the regular API
+    LFUCache<std::string, int, 2> hashedCache;
+    std::hash<std::string> stringHasher;
+    std::string hashedKeys[3] = {std::string(96, 'a'), std::string(96, 'b'), std::string(96, 'c')};
+    hashedCache.PutWithHash(hashedKeys[0], stringHasher(hashedKeys[0]), 1);
+    hashedCache.Put(hashedKeys[1], 2);
+    int hashedValue = 0;
+    bool hashedHit = hashedCache.TryGetWithHash(hashedKeys[1], stringHasher(hashedKeys[1]), hashedValue);
+    hashedCache.PutWithHash(hashedKeys[2], stringHasher(hashedKeys[2]), 3);  // evicts key 0 via its stored hash
+    test.test(hashedHit && hashedValue == 2 && hashedCache.GetWithHash(hashedKeys[2], stringHasher(hashedKeys[2])) == 3
+              && !hashedCache.Contains(hashedKeys[0]) && hashedCache.Get(hashedKeys[1]) == 2,
+              "GetWithHash/PutWithHash - match Get/Put and evict by stored hash");
+    
+    // Test eviction listener: evicted entries are moved out, never copied
+    LFUCache<int, CopyCountingValue, 2, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, RecyclingListener> listenedCache;
+    listenedCache.Listener().pool.reserve(4);
+    CopyCountingValue::copies = 0;
+    for (int key = 0; key < 4; ++key) {
+        listenedCache.Put(key, CopyCountingValue(4096));
+    }
+    const std::vector<CopyCountingValue>& recycled = listenedCache.Listener().pool;
+    test.test(listenedCache.Listener().evictedKeys == std::vector<int>{0, 1} && recycled.size() == 2
+              && recycled[0].buffer.size() == 4096 && CopyCountingValue::copies == 0,
+              "Eviction listener - evicted entries moved out without copies");
+    
+    // Test byte-weighted capacity: inserts evict from the LFU end until the budget holds
+    LFUCache<int, std::string, 100, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+             StringSizeWeigher> weightedCache;
+    weightedCache.SetMaxWeight(10000);
+    weightedCache.Put(1, std::string(4000, 'a'));
+    weightedCache.Put(2, std::string(4000, 'b'));
+    weightedCache.Get(1);
+    weightedCache.Put(3, std::string(4000, 'c'));  // 12000 > 10000: key 2 (least frequent) goes
+    bool weightedEvicted = weightedCache.Size() == 2 && !weightedCache.Contains(2) && weightedCache.Weight() == 8000;
+    weightedCache.Put(3, std::string(7000, 'c'));  // growing an entry also evicts
+    bool growEvicted = weightedCache.Size() == 1 && weightedCache.Contains(3) && weightedCache.Weight() == 7000;
+    weightedCache.Put(4, std::string(20000, 'd'));  // heavier than the budget: kept alone
+    test.test(weightedEvicted && growEvicted && weightedCache.Size() == 1 && weightedCache.Weight() == 20000,
+              "Weighted capacity - evicts by byte budget on insert and update");
+    
+    // Test weighted capacity with dynamic aging: a victim from above the LFU bucket must not
+    // raise the cache age past a live bucket, or new entries would break the bucket order
+    LFUCache<int, std::string, 100, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+             StringSizeWeigher> agedWeightedCache;
+    agedWeightedCache.SetDynamicAging(true);
+    agedWeightedCache.SetMaxWeight(100);
+    agedWeightedCache.Put(1, std::string(5, 'a'));
+    agedWeightedCache.Get(1);
+    agedWeightedCache.Get(1);
+    agedWeightedCache.Put(2, std::string(5, 'b'));
+    agedWeightedCache.Get(2);
+    agedWeightedCache.Get(2);
+    agedWeightedCache.Put(4, std::string(91, 'd'));  // Alone in the LFU bucket: key 1 goes instead
+    agedWeightedCache.Put(6, std::string(1, 'f'));
+    bool agedOrdered = agedWeightedCache.MinFrequency() == 1 && !agedWeightedCache.Contains(1);
+    agedWeightedCache.Put(7, std::string(10, 'g'));  // Key 4 is still the least frequent
+    test.test(agedOrdered && !agedWeightedCache.Contains(4) && agedWeightedCache.Contains(2)
+              && agedWeightedCache.Contains(6) && agedWeightedCache.Contains(7),
+              "Weighted capacity - dynamic aging keeps buckets ordered when skipping the kept entry");
+    
+    // Test TTL expiry: lazy on Get, timer wheel reclaims the rest before any LFU eviction
+    using ExpiringCache = LFUCache<int, int, 4, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>,
+                                   LFUNoEvictionListener, LFUUnitWeigher, LFUTimerWheelExpiry<ManualClock>>;
+    ManualClock::current = ManualClock::time_point{};
+    ExpiringCache expiringCache;
+    expiringCache.SetDefaultTTL(std::chrono::milliseconds(100));
+    expiringCache.Put(1, 10);
+    expiringCache.PutWithTTL(2, 20, std::chrono::hours(24));  // Beyond level 0: must survive cascades
+    expiringCache.PutWithTTL(3, 30, std::chrono::milliseconds(0));  // Never expires
+    ManualClock::current += std::chrono::milliseconds(100);
+    bool lazyExpired = expiringCache.Get(1) == 0 && expiringCache.Size() == 2;
+    expiringCache.Put(4, 40);
+    expiringCache.Put(5, 50);
+    for (int i = 0; i < 3; ++i) {
+        expiringCache.Get(4);
+    }
+    ManualClock::current += std::chrono::milliseconds(150);
+    bool purged = expiringCache.PurgeExpired() == 2 && expiringCache.Size() == 2;
+    expiringCache.Put(6, 60);
+    expiringCache.Put(7, 70);
+    ManualClock::current += std::chrono::milliseconds(500);
+    expiringCache.Put(8, 80);  // Full: expired 6 and 7 make room, not the LFU victim 3
+    bool expiredFirst = expiringCache.Size() == 3 && expiringCache.Contains(2) && expiringCache.Contains(3);
+    ManualClock::current += std::chrono::hours(24);
+    bool longExpired = !expiringCache.Contains(2) && expiringCache.PurgeExpired() == 2 && expiringCache.Get(3) == 30;
+    test.test(lazyExpired && purged && expiredFirst && longExpired,
+              "TTL expiry - lazy on Get, wheel purge and expired-first eviction");
+    
+    // Writes to an expired entry expire it and insert afresh, at frequency 1, instead of reviving it
+    using ExpiringStatsCache = LFUCache<int, int, 4, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>,
+                                        LFUNoEvictionListener, LFUUnitWeigher, LFUTimerWheelExpiry<ManualClock>,
+                                        LFUCountingStats>;
+    auto rewriteExpired = [](auto write) {
+        ExpiringStatsCache staleCache;
+        staleCache.SetDefaultTTL(std::chrono::milliseconds(100));
+        staleCache.Put(1, 10);
+        for (int i = 0; i < 5; ++i) {
+            staleCache.Get(1);
+        }
+        ManualClock::current += std::chrono::milliseconds(100);
+        bool inserted = write(staleCache);
+        LFUCacheStats stats = staleCache.Statistics();
+        return inserted && staleCache.MinFrequency() == 1 && staleCache.Get(1) == 11 && stats.expirations == 1
+            && stats.inserts == 2 && stats.updates == 0;
+    };
+    test.test(rewriteExpired([](ExpiringStatsCache& cache) { cache.Put(1, 11); return true; })
+              && rewriteExpired([](ExpiringStatsCache& cache) { return cache.Emplace(1, 11); })
+              && rewriteExpired([](ExpiringStatsCache& cache) { return cache.TryEmplace(1, 11); }),
+              "TTL expiry - Put, Emplace and TryEmplace replace an expired entry afresh");
+    
+    // Test statistics: hits, misses, inserts, updates and the victim's frequency are counted
+    LFUCache<int, int, 2, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+             LFUUnitWeigher, LFUNoExpiry, LFUCountingStats> statsCache;
+    statsCache.Put(1, 10);
+    statsCache.Put(2, 20);
+    statsCache.Get(1);
+    statsCache.Get(3);
+    statsCache.Put(1, 11);
+    statsCache.Put(3, 30);  // Evicts key 2 at frequency 1
+    LFUCacheStats counted = statsCache.Statistics();
+    statsCache.ResetStatistics();
+    test.test(counted.hits == 1 && counted.misses == 1 && counted.inserts == 3 && counted.updates == 1
+              && counted.evictions == 1 && counted.evictedFrequency[1] == 1 && counted.HitRatio() == 0.5
+              && statsCache.Statistics().hits == 0,
+              "Statistics - hit, miss, insert, update and eviction counters");
+    
+    // Test latency histograms: log-linear buckets, per-operation recording and sampling
+    LFULatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 1000; ++ns) {
+        histogram.Record(ns);
+    }
+    uint64_t median = histogram.Percentile(50);
+    bool bucketsAccurate = histogram.Count() == 1000 && median >= 500 && median <= 500 + 500 / 16
+        && histogram.Percentile(100) == 1000 && histogram.Percentile(0) == 1;
+    LFUCache<int, int, 2, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+             LFUUnitWeigher, LFUNoExpiry, LFULatencyStats<>> timedCache;
+    timedCache.Put(1, 10);
+    timedCache.Put(2, 20);
+    timedCache.Put(3, 30);
+    timedCache.Put(3, 31);
+    timedCache.Get(3);
+    timedCache.Get(1);
+    bool perOperation = timedCache.Latency(LFUOperation::PutInsert).Count() == 2
+        && timedCache.Latency(LFUOperation::PutEvict).Count() == 1
+        && timedCache.Latency(LFUOperation::PutUpdate).Count() == 1
+        && timedCache.Latency(LFUOperation::GetHit).Count() == 1 && timedCache.Latency(LFUOperation::GetMiss).Count() == 1;
+    LFUCache<int, int, 64, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+             LFUUnitWeigher, LFUNoExpiry, LFULatencyStats<2>> sampledCache;
+    for (int i = 0; i < 400; ++i) {
+        sampledCache.Get(i);
+    }
+    test.test(bucketsAccurate && perOperation && sampledCache.Latency(LFUOperation::GetMiss).Count() == 100
+              && sampledCache.Statistics().misses == 400,
+              "Latency histograms - percentiles, per-operation classes and 1-in-4 sampling");
+    
+    // Test eviction policies: LRU ignores frequency, evicting the least recently used entry
+    using LRUCache = LFUCache<int, int, 3, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+                              LFUUnitWeigher, LFUNoExpiry, LFUNoStats, LRUEviction>;
+    LRUCache lruCache;
+    lruCache.Put(1, 1);
+    lruCache.Put(2, 2);
+    lruCache.Put(3, 3);
+    for (int i = 0; i < 5; ++i) {
+        lruCache.Get(1);
+    }
+    lruCache.Get(2);
+    lruCache.Get(3);
+    lruCache.Put(4, 4);  // Key 1 is the most frequent but the least recent
+    size_t lruLinked = 0;
+    lruCache.EvictionPolicy().ForEach([&](uint32_t) { ++lruLinked; });
+    test.test(!lruCache.Contains(1) && lruCache.Contains(2) && lruCache.Contains(4) && lruLinked == 3,
+              "Eviction policy LRU - evicts the least recent entry regardless of frequency");
+    
+    // Test S3-FIFO: a scan of one-hit keys churns the small queue; a recent ghost re-enters main
+    using S3FIFOCache = LFUCache<int, int, 10, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+                                 LFUUnitWeigher, LFUNoExpiry, LFUNoStats, S3FIFOEviction<>>;
+    S3FIFOCache s3fifoCache;
+    for (int i = 0; i < 10; ++i) {
+        s3fifoCache.Put(i, i);
+        s3fifoCache.Get(i);
+    }
+    for (int i = 100; i < 200; ++i) {
+        s3fifoCache.Put(i, i);
+    }
+    bool hotSurvived = true;
+    for (int i = 1; i < 10; ++i) {
+        hotSurvived = hotSurvived && s3fifoCache.Contains(i);
+    }
+    s3fifoCache.Put(195, 195);  // Still in the ghost list, so it goes straight to main
+    for (int i = 200; i < 250; ++i) {
+        s3fifoCache.Put(i, i);
+    }
+    test.test(hotSurvived && s3fifoCache.Contains(195) && s3fifoCache.Size() == 10,
+              "Eviction policy S3-FIFO - scans stay in the small queue, ghost hits go to main");
+    
+    // Test ARC: frequent entries survive a scan; a ghost hit in B1 grows the recency target
+    using ARCCache = LFUCache<int, int, 4, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+                              LFUUnitWeigher, LFUNoExpiry, LFUNoStats, ARCEviction>;
+    ARCCache arcCache;
+    arcCache.Put(1, 1);
+    arcCache.Put(2, 2);
+    arcCache.Get(1);
+    arcCache.Get(2);
+    for (int i = 3; i <= 20; ++i) {
+        arcCache.Put(i, i);
+    }
+    bool scanResistant = arcCache.Contains(1) && arcCache.Contains(2) && arcCache.EvictionPolicy().Target() == 0;
+    arcCache.Put(17, 17);  // Evicted from T1 moments ago
+    test.test(scanResistant && arcCache.EvictionPolicy().Target() == 1 && arcCache.Contains(17)
+              && arcCache.Contains(1) && arcCache.Contains(2),
+              "Eviction policy ARC - frequent entries survive scans and the target adapts");
+    
+    // Test LIRS: a loop slightly larger than the cache keeps a stable LIR set where LRU never hits
+    using LIRSCache = LFUCache<int, int, 10, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>, LFUNoEvictionListener,
+                               LFUUnitWeigher, LFUNoExpiry, LFUNoStats, LIRSEviction<>>;
+    using LoopLRUCache = LFUCache<int, int, 10, std::hash<int>, LFUAlwaysAdmit, std::equal_to<int>,
+                                  LFUNoEvictionListener, LFUUnitWeigher, LFUNoExpiry, LFUNoStats, LRUEviction>;
+    LIRSCache lirsCache;
+    LoopLRUCache loopLruCache;
+    int lirsHits = 0;
+    int loopLruHits = 0;
+    for (int round = 0; round < 50; ++round) {
+        for (int key = 0; key < 12; ++key) {
+            int value;
+            if (lirsCache.TryGet(key, value)) {
+                ++lirsHits;
+            } else {
+                lirsCache.Put(key, key);
+            }
+            if (loopLruCache.TryGet(key, value)) {
+                ++loopLruHits;
+            } else {
+                loopLruCache.Put(key, key);
+            }
+        }
+    }
+    test.test(lirsHits > 400 && loopLruHits == 0 && lirsCache.Size() == 10,
+              "Eviction policy LIRS - loops larger than the cache keep hitting");
+    
+    // Test snapshots: frequencies survive a save/load round trip; a smaller cache keeps the hottest
+    LFUCache<std::string, int, 8> snapshotSource;
+    for (int i = 1; i <= 5; ++i) {
+        snapshotSource.Put("key" + std::to_string(i), i);
+        for (int hit = 1; hit < i; ++hit) {
+            snapshotSource.Get("key" + std::to_string(i));
+        }
+    }
+    std::stringstream snapshot;
+    snapshotSource.SaveSnapshot(snapshot);
+    LFUCache<std::string, int, 3> snapshotTarget;
+    snapshotTarget.LoadSnapshot(snapshot);
+    bool hottestLoaded = snapshotTarget.Size() == 3 && snapshotTarget.MinFrequency() == 3
+        && snapshotTarget.Contains("key3") && snapshotTarget.Contains("key5") && !snapshotTarget.Contains("key2");
+    snapshotTarget.Put("fresh", 0);  // key3 (frequency 3) is the victim, not key4 or key5
+    hottestLoaded = hottestLoaded && !snapshotTarget.Contains("key3") && snapshotTarget.Get("key5") == 5;
+    std::string truncated = snapshot.str().substr(0, snapshot.str().size() - 2);
+    std::stringstream corrupt(truncated);
+    bool corruptRejected = false;
+    try {
+        snapshotTarget.LoadSnapshot(corrupt);
+    } catch (const std::runtime_error&) {
+        corruptRejected = snapshotTarget.Size() == 0;
+    }
+    test.test(hottestLoaded && corruptRejected, "Snapshot - bulk load keeps frequencies and rejects truncation");
+    
+    // Fixed-size entries load a 4 KB chunk at a time: 700 entries span several chunks
+    LFUCache<uint64_t, uint64_t, 1000> chunkedSource;
+    for (uint64_t key = 0; key < 700; ++key) {
+        chunkedSource.Put(key, key * 3);
+        if (key % 2 == 0) {
+            chunkedSource.Get(key);
+        }
+    }
+    std::stringstream chunkedSnapshot;
+    chunkedSource.SaveSnapshot(chunkedSnapshot);
+    LFUCache<uint64_t, uint64_t, 1000> chunkedTarget;
+    chunkedTarget.LoadSnapshot(chunkedSnapshot);
+    bool chunkedIntact = chunkedTarget.Size() == 700 && chunkedTarget.MinFrequency() == 1;
+    for (uint64_t key = 0; key < 700; ++key) {
+        chunkedIntact = chunkedIntact && chunkedTarget.Get(key) == key * 3;
+    }
+    test.test(chunkedIntact, "Snapshot - chunked bulk load of fixed-size entries");
+    
+    // Expired entries not yet reclaimed stay out of a snapshot, with their emptied buckets
+    ExpiringCache staleSource;
+    staleSource.SetDefaultTTL(std::chrono::milliseconds(100));
+    staleSource.Put(1, 10);
+    staleSource.Put(2, 20);
+    staleSource.PutWithTTL(3, 30, std::chrono::milliseconds(0));
+    for (int i = 0; i < 3; ++i) {
+        staleSource.Get(1);
+    }
+    staleSource.Get(3);
+    ManualClock::current += std::chrono::milliseconds(100);
+    std::stringstream staleSnapshot;
+    staleSource.SaveSnapshot(staleSnapshot);
+    ExpiringCache staleTarget;
+    staleTarget.LoadSnapshot(staleSnapshot);
+    test.test(staleTarget.Size() == 1 && staleTarget.MinFrequency() == 2 && staleTarget.Get(3) == 30
+              && !staleTarget.Contains(1) && !staleTarget.Contains(2),
+              "Snapshot - expired entries are not saved");
+    
+#ifdef LFU_CACHE_HAS_MMAP
+    // Test persistence: a reopened file resumes entries and frequencies; a new schema starts empty
+    using PersistentCache = PersistentLFUCache<int, double, 3>;
+    std::string persistPath = (std::filesystem::temp_directory_path() / "lfu_cache_test.bin").string();
+    std::filesystem::remove(persistPath);
+    bool startedEmpty = false;
+    {
+        PersistentCache persistent(persistPath);
+        startedEmpty = !persistent.Restored() && persistent->Size() == 0;
+        persistent->Put(1, 1.5);
+        persistent->Put(2, 2.5);
+        persistent->Put(3, 3.5);
+        persistent->Get(1);
+        persistent->Get(3);
+    }
+    bool resumed = false;
+    {
+        PersistentCache persistent(persistPath);
+        resumed = persistent.Restored() && persistent->Size() == 3 && persistent->Get(1) == 1.5;
+        persistent->Put(4, 4.5);  // Key 2 is still the least frequently used
+        resumed = resumed && !persistent->Contains(2) && persistent->Contains(3);
+    }
+    PersistentCache reset(persistPath, 2);
+    test.test(startedEmpty && resumed && !reset.Restored() && reset->Size() == 0,
+              "Persistent cache - resumes entries and frequencies after reopening");
+    std::filesystem::remove(persistPath);
+#endif
+    
+    // Test zero-copy access: Find() points into the cache and counts as a hit
+    LFUCache<int, std::string, 2> viewCache;
+    viewCache.Put(1, "one");
+    viewCache.Put(2, "two");
+    const std::string* view = viewCache.Find(1);
+    viewCache.Put(3, "three");  // evicts key 2, the only frequency-1 entry
+    size_t visitedLength = 0;
+    bool visited = viewCache.Visit(1, [&](const std::string& value) { visitedLength = value.size(); });
+    test.test(view != nullptr && *view == "one" && viewCache.Find(2) == nullptr && visited && visitedLength == 3,
+              "Find/Visit - zero-copy hits refresh frequency and pointers survive other inserts");
+    
+    // Test move-aware Put and in-place Emplace/TryEmplace
+    LFUCache<std::string, std::string, 10> moveCache;
+    std::string movedKey = "alpha";
+    std::string movedValue(64, 'a');
+    moveCache.Put(std::move(movedKey), std::move(movedValue));
+    bool emplaced = moveCache.Emplace("beta", 3, 'b');
+    bool replaced = moveCache.Emplace("beta", 2, 'c');
+    bool tried = moveCache.TryEmplace("alpha", 5, 'z');
+    test.test(movedValue.empty() && moveCache.GetOrDefault("alpha", "") == std::string(64, 'a') && emplaced
+              && !replaced && moveCache.GetOrDefault("beta", "") == "cc" && !tried,
+              "Put/Emplace/TryEmplace - values moved or constructed in place");
+
     // Test hybrid API - noexcept vs throwing versions
     LFUCache<int, int, 10> hybridCache;
-    hybridCache.put(1, 100);
-    hybridCache.put(2, 200);
+    hybridCache.Put(1, 100);
+    hybridCache.Put(2, 200);
     
     // Test noexcept get() - returns default value for missing keys
-    test.test(hybridCache.get(1) == 100, "Hybrid API - noexcept get for existing key");
-    test.test(hybridCache.get(999) == 0, "Hybrid API - noexcept get for missing key returns default");
+    test.test(hybridCache.Get(1) == 100, "Hybrid API - noexcept get for existing key");
+    test.test(hybridCache.Get(999) == 0, "Hybrid API - noexcept get for missing key returns default");
     
     // Test throwing getOrThrow() - should work for existing keys
-    test.test(hybridCache.getOrThrow(2) == 200, "Hybrid API - getOrThrow for existing key");
+    test.test(hybridCache.GetOrThrow(2) == 200, "Hybrid API - getOrThrow for existing key");
     
     // Test that getOrThrow() throws for missing keys
     bool exceptionThrown = false;
     try {
-        hybridCache.getOrThrow(999);
+        hybridCache.GetOrThrow(999);
     } catch (const std::runtime_error&) {
         exceptionThrown = true;
     }
@@ -144,12 +725,12 @@ void runPerformanceComparison() {
         int op = opDist(gen);
         
         if (op < 70) {
-            if (originalCache.contains(key)) {
-                originalCache.get(key);
+            if (originalCache.Contains(key)) {
+                originalCache.Get(key);
                 originalHits++;
             }
         } else {
-            originalCache.put(key, key * 10);
+            originalCache.Put(key, key * 10);
         }
     }
     
@@ -169,12 +750,12 @@ void runPerformanceComparison() {
         int op = opDist(gen);
         
         if (op < 70) {
-            if (optimizedCache.contains(key)) {
-                optimizedCache.get(key);  // Use noexcept version for performance
+            if (optimizedCache.Contains(key)) {
+                optimizedCache.Get(key);  // Use noexcept version for performance
                 optimizedHits++;
             }
         } else {
-            optimizedCache.put(key, key * 10);
+            optimizedCache.Put(key, key * 10);
         }
     }
     
@@ -223,28 +804,32 @@ void runStaticOptimizationValidation() {
     OptimizedTestRunner test;
     
     // Test 1: Verify dead code elimination worked (no capacity <= 0 checks in put)
-    LFUCache<int, int, 10> cache;
-    cache.put(1, 100);  // Should work without dead code check
-    test.test(cache.contains(1), "Dead code elimination - put works without redundant capacity check");
+    LFUCache<int, int, 5> cache;
+    cache.Put(1, 100);  // Should work without dead code check
+    test.test(cache.Contains(1), "Dead code elimination - put works without redundant capacity check");
     
     // Test 2: Verify constant folding (MIN_FREQUENCY_SIZE used correctly)
     LFUCache<int, int, 50> largeCache;
     // The cache should initialize with MIN_FREQUENCY_SIZE (16) elements
-    test.test(largeCache.size() == 0, "Constant folding - initialization with folded constants");
+    test.test(largeCache.Size() == 0, "Constant folding - initialization with folded constants");
     
     // Test 3: Verify function inlining (functions should work correctly if inlined)
     for (int i = 0; i < 10; ++i) {
-        cache.put(i, i * 10);
+        cache.Put(i, i * 10);
     }
-    test.test(cache.size() == 5, "Function inlining - capacity respected with inlined functions");
+    test.test(cache.Size() == 5, "Function inlining - capacity respected with inlined functions");
     
     // Test 4: Verify memory layout optimization (Node alignment)
     // This is more of a compilation check - if it compiles, alignment worked
     test.test(sizeof(LFUCache<int, int, 10>::Node) <= 64, "Memory efficiency - Node size is compact");
     
+    // Test 4b: Verify compact links (16-bit indices for pools below 64K entries)
+    test.test(sizeof(LFUCache<int, int, 1000>::Node) == 16, "Compact links - 16-bit node links for small pools");
+    test.test(sizeof(LFUCache<int, int, 100000>::Node) <= 20, "Compact links - 32-bit node links for large pools");
+    
     // Test 5: Verify loop optimization (clear function with std::iota)
-    cache.clear();
-    test.test(cache.size() == 0, "Loop optimization - clear uses optimized algorithm");
+    cache.Clear();
+    test.test(cache.Size() == 0, "Loop optimization - clear uses optimized algorithm");
     
     // Test 6: Verify template specialization compilation
     LFUCache<int, int, 100> intCache;
@@ -254,6 +839,25 @@ void runStaticOptimizationValidation() {
     test.printResults();
 }
 
+// Node layout of the previous pointer-linked design, for the size comparison table
+template<typename Key, typename Value>
+struct PointerLinkedNode {
+    int frequency;
+    PointerLinkedNode* prev;
+    PointerLinkedNode* next;
+    Key key;
+    Value value;
+};
+
+template<typename Key, typename Value, size_t MAX_SIZE>
+void printNodeSizeRow(const std::string& name) {
+    using Cache = LFUCache<Key, Value, MAX_SIZE>;
+    std::cout << "  " << std::left << std::setw(34) << name << std::right
+              << std::setw(6) << sizeof(typename Cache::IndexType) * 8 << "-bit"
+              << std::setw(10) << sizeof(typename Cache::Node) << " B"
+              << std::setw(10) << sizeof(PointerLinkedNode<Key, Value>) << " B\n";
+}
+
 // Memory usage and cache efficiency test
 void runMemoryEfficiencyTest() {
     std::cout << "========== MEMORY EFFICIENCY TEST ==========\n";
@@ -269,16 +873,30 @@ void runMemoryEfficiencyTest() {
         std::cout << "✓ Nodes are compact for efficient memory usage\n";
     }
     
+    // Link width is chosen from MAX_SIZE at compile time
+    std::cout << "\nNode size by Key/Value and capacity:\n";
+    std::cout << "  " << std::left << std::setw(34) << "LFUCache<Key, Value, MAX_SIZE>" << std::right
+              << std::setw(10) << "links" << std::setw(12) << "node" << std::setw(12) << "pointers" << "\n";
+    printNodeSizeRow<int, int, 1000>("<int, int, 1000>");
+    printNodeSizeRow<int, int, 1000000>("<int, int, 1000000>");
+    printNodeSizeRow<int64_t, int64_t, 1000>("<int64_t, int64_t, 1000>");
+    printNodeSizeRow<int64_t, int64_t, 1000000>("<int64_t, int64_t, 1000000>");
+    printNodeSizeRow<int, double, 1000>("<int, double, 1000>");
+    printNodeSizeRow<uint64_t, float, 1000000>("<uint64_t, float, 1000000>");
+    printNodeSizeRow<std::string, int, 1000>("<std::string, int, 1000>");
+    printNodeSizeRow<std::string, std::string, 1000>("<std::string, std::string, 1000>");
+    std::cout << "\n";
+    
     // Fill cache and measure access patterns
     auto start = std::chrono::high_resolution_clock::now();
     
     for (int i = 0; i < 500; ++i) {
-        cache.put(i, i * 2);
+        cache.Put(i, i * 2);
     }
     
     // Sequential access pattern (cache-friendly)
     for (int i = 0; i < 500; ++i) {
-        volatile int value = cache.get(i);
+        volatile int value = cache.Get(i);
         (void)value;
     }
     
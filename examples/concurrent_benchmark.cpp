@@ -0,0 +1,192 @@
+/*
+ * Multi-threaded Scaling Benchmark
+ *
+ * Measures throughput of ShardedLFUCache against a single LFUCache behind one
+ * global mutex, at 1..N threads, for uniform and Zipfian key distributions, and
+ * counts backend loads during a cold start with and without GetOrCompute().
+ *
+ * Usage: ./concurrent_benchmark [max_threads]
+ */
+
+#include "lfu_cache.h"
+#include "workload_generators.h"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr size_t CACHE_CAPACITY = 65536;
+static constexpr size_t SHARD_COUNT = 64;
+static constexpr int KEY_SPACE = 262144;
+static constexpr int OPS_PER_THREAD = 1000000;
+static constexpr int GET_PERCENT = 90;
+
+// Single cache behind one mutex: the baseline this benchmark is meant to replace
+class GlobalLockCache {
+public:
+    inline int Get(int key) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cache.Get(key);
+    }
+
+    inline void Put(int key, int value) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.Put(key, value);
+    }
+
+private:
+    std::mutex mutex;
+    LFUCache<int, int, CACHE_CAPACITY> cache;
+};
+
+using ShardedCache = ShardedLFUCache<int, int, CACHE_CAPACITY, SHARD_COUNT>;
+
+// Pre-generated per-thread key streams keep RNG cost out of the timed region.
+// Keys are scrambled so hot Zipfian ranks do not cluster in one shard.
+std::vector<std::vector<int>> makeKeyStreams(int threads, bool zipfian) {
+    std::vector<std::vector<int>> streams(threads);
+    ZipfianGenerator zipf(KEY_SPACE, 0.99);
+    for (int t = 0; t < threads; ++t) {
+        std::mt19937_64 rng(1234 + t);
+        std::uniform_int_distribution<int> uniform(0, KEY_SPACE - 1);
+        streams[t].reserve(OPS_PER_THREAD);
+        for (int i = 0; i < OPS_PER_THREAD; ++i) {
+            int rank = zipfian ? zipf(rng) : uniform(rng);
+            streams[t].push_back(static_cast<int>((static_cast<uint32_t>(rank) * 2654435761u) % KEY_SPACE));
+        }
+    }
+    return streams;
+}
+
+template<typename CacheType>
+double runThreads(CacheType& cache, const std::vector<std::vector<int>>& streams) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+
+    for (size_t t = 0; t < streams.size(); ++t) {
+        workers.emplace_back([&, t] {
+            const std::vector<int>& keys = streams[t];
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            int sink = 0;
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                if (i % 100 < GET_PERCENT) {
+                    sink += cache.Get(keys[i]);
+                } else {
+                    cache.Put(keys[i], i);
+                }
+            }
+            volatile int consume = sink;
+            (void)consume;
+        });
+    }
+
+    while (ready.load() < static_cast<int>(streams.size())) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return streams.size() * static_cast<double>(OPS_PER_THREAD) / seconds;
+}
+
+template<typename CacheType>
+double benchmark(int threads, bool zipfian) {
+    auto cache = std::make_unique<CacheType>();
+    auto streams = makeKeyStreams(threads, zipfian);
+
+    // Warm the cache with one pass of the first stream
+    for (int key : streams[0]) {
+        cache->Put(key, key);
+    }
+    return runThreads(*cache, streams);
+}
+
+// Cold start: every thread requests the same COLD_KEYS keys from an empty cache through
+// a loader that takes LOADER_MICROS. Returns the number of loader calls.
+static constexpr int COLD_KEYS = 256;
+static constexpr int LOADER_MICROS = 200;
+
+int coldStartLoads(int threads, bool singleFlight) {
+    auto cache = std::make_unique<ShardedCache>();
+    std::atomic<int> loads{0};
+    auto loader = [&loads](int key) {
+        loads.fetch_add(1);
+        std::this_thread::sleep_for(std::chrono::microseconds(LOADER_MICROS));
+        return key;
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            int sink = 0;
+            for (int key = 0; key < COLD_KEYS; ++key) {
+                if (singleFlight) {
+                    sink += cache->GetOrCompute(key, loader);
+                } else {
+                    if (!cache->Contains(key)) {
+                        cache->Put(key, loader(key));
+                    }
+                    sink += cache->Get(key);
+                }
+            }
+            volatile int consume = sink;
+            (void)consume;
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return loads.load();
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::stoi(argv[1])
+                              : static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+
+    std::cout << "=== MULTI-THREADED SCALING BENCHMARK ===\n";
+    std::cout << "Capacity: " << CACHE_CAPACITY << ", shards: " << SHARD_COUNT
+              << ", key space: " << KEY_SPACE << ", " << GET_PERCENT << "% gets\n";
+    std::cout << "Operations per thread: " << OPS_PER_THREAD << "\n";
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+    for (bool zipfian : {false, true}) {
+        std::cout << (zipfian ? "Zipfian keys (theta = 0.99):\n" : "Uniform keys:\n");
+        std::cout << std::setw(10) << "threads" << std::setw(20) << "global mutex"
+                  << std::setw(20) << "sharded" << std::setw(12) << "speedup" << "\n";
+
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            double globalOps = benchmark<GlobalLockCache>(threads, zipfian);
+            double shardedOps = benchmark<ShardedCache>(threads, zipfian);
+            std::cout << std::setw(10) << threads
+                      << std::setw(20) << std::fixed << std::setprecision(0) << globalOps
+                      << std::setw(20) << shardedOps
+                      << std::setw(11) << std::setprecision(2) << shardedOps / globalOps << "x\n";
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "Cold start, " << COLD_KEYS << " keys, " << LOADER_MICROS << " us loader (loader calls):\n";
+    std::cout << std::setw(10) << "threads" << std::setw(20) << "Contains+Put+Get"
+              << std::setw(20) << "GetOrCompute" << "\n";
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        std::cout << std::setw(10) << threads << std::setw(20) << coldStartLoads(threads, false)
+                  << std::setw(20) << coldStartLoads(threads, true) << "\n";
+    }
+
+    return 0;
+}
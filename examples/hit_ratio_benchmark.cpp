@@ -0,0 +1,114 @@
+/*
+ * Hit Ratio Benchmark
+ *
+ * Compares plain LFU eviction with W-TinyLFU admission on traces that mix a
+ * Zipfian hot set with long sequential scans of cold keys. Plain LFU admits
+ * every scanned key at frequency 1, so scan keys evict each other but also
+ * keep displacing warm entries that have not yet built up frequency; TinyLFU
+ * rejects scan keys at the window boundary because the sketch has never seen
+ * them before. A third column runs plain LFU with dynamic aging (LFU-DA) on
+ * traces whose hot set moves every phase, where stale counts otherwise pin
+ * the previous phase's keys in the cache.
+ *
+ * Usage: ./hit_ratio_benchmark
+ */
+
+#include "lfu_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+static constexpr size_t CACHE_CAPACITY = 4096;
+static constexpr int HOT_KEYS = 65536;
+static constexpr int TRACE_LENGTH = 2000000;
+
+using PlainCache = LFUCache<int, int, CACHE_CAPACITY>;
+using TinyLFUCache = LFUCache<int, int, CACHE_CAPACITY, std::hash<int>, TinyLFUAdmission<>>;
+
+static constexpr int COLD_KEY_BASE = 1 << 30;
+
+// Zipf-distributed hot keys, interrupted every scanEvery accesses by a scan of
+// scanLength never-repeated cold keys. Every phaseLength accesses the hot set is
+// replaced by HOT_KEYS fresh keys with the same popularity distribution.
+std::vector<int> makeTrace(double skew, int scanEvery, int scanLength, int phaseLength, unsigned seed) {
+    std::vector<double> cdf(HOT_KEYS);
+    double sum = 0;
+    for (int i = 0; i < HOT_KEYS; ++i) {
+        sum += 1.0 / std::pow(i + 1, skew);
+        cdf[i] = sum;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    std::vector<int> trace;
+    trace.reserve(TRACE_LENGTH);
+    int nextColdKey = COLD_KEY_BASE;
+    while (trace.size() < TRACE_LENGTH) {
+        for (int i = 0; i < scanEvery && trace.size() < TRACE_LENGTH; ++i) {
+            int rank = static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+            trace.push_back(rank + static_cast<int>(trace.size() / phaseLength) * HOT_KEYS);
+        }
+        for (int i = 0; i < scanLength && trace.size() < TRACE_LENGTH; ++i) {
+            trace.push_back(nextColdKey++);
+        }
+    }
+    return trace;
+}
+
+// Read-through usage: every miss is followed by a Put of the key
+template<typename CacheType>
+double hitRatio(const std::vector<int>& trace, bool dynamicAging = false) {
+    auto cache = std::make_unique<CacheType>();
+    cache->SetDynamicAging(dynamicAging);
+    size_t hits = 0;
+    for (int key : trace) {
+        if (cache->Contains(key)) {
+            cache->Get(key);
+            ++hits;
+        } else {
+            cache->Put(key, key);
+        }
+    }
+    return 100.0 * hits / trace.size();
+}
+
+int main() {
+    struct Workload {
+        const char* name;
+        double skew;
+        int scanEvery;
+        int scanLength;
+        int phaseLength;
+    };
+    const Workload workloads[] = {
+        {"zipf 0.9, no scans", 0.9, TRACE_LENGTH, 0, TRACE_LENGTH},
+        {"zipf 0.9, 5K scan every 20K", 0.9, 20000, 5000, TRACE_LENGTH},
+        {"zipf 0.9, 20K scan every 20K", 0.9, 20000, 20000, TRACE_LENGTH},
+        {"zipf 0.7, 5K scan every 20K", 0.7, 20000, 5000, TRACE_LENGTH},
+        {"zipf 1.1, 50K scan every 100K", 1.1, 100000, 50000, TRACE_LENGTH},
+        {"zipf 0.9, hot set moves every 500K", 0.9, TRACE_LENGTH, 0, 500000},
+        {"zipf 0.9, hot set moves every 100K", 0.9, TRACE_LENGTH, 0, 100000},
+        {"zipf 1.1, moves every 200K + scans", 1.1, 20000, 5000, 200000},
+    };
+
+    std::cout << "=== HIT RATIO: LFU vs LFU-DA vs W-TinyLFU ===\n";
+    std::cout << "Capacity: " << CACHE_CAPACITY << ", hot keys: " << HOT_KEYS
+              << ", trace length: " << TRACE_LENGTH << "\n\n";
+    std::cout << std::left << std::setw(38) << "workload" << std::right
+              << std::setw(12) << "LFU" << std::setw(12) << "LFU-DA" << std::setw(12) << "TinyLFU" << "\n";
+
+    for (const Workload& workload : workloads) {
+        auto trace = makeTrace(workload.skew, workload.scanEvery, workload.scanLength, workload.phaseLength, 42);
+        double plain = hitRatio<PlainCache>(trace);
+        double aged = hitRatio<PlainCache>(trace, true);
+        double tiny = hitRatio<TinyLFUCache>(trace);
+        std::cout << std::left << std::setw(38) << workload.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(11) << plain << "%" << std::setw(11) << aged << "%" << std::setw(11) << tiny << "%\n";
+    }
+
+    return 0;
+}
@@ -16,25 +16,25 @@ void demonstrateHotPath() {
     LFUCache<int, std::string, 500> cache;
     
     // Hot path operations - all noexcept
-    cache.put(1, "user1");
-    cache.put(2, "user2");
-    cache.put(3, "user3");
+    cache.Put(1, "user1");
+    cache.Put(2, "user2");
+    cache.Put(3, "user3");
     
     // High-performance access - no exceptions thrown
-    if (cache.contains(1)) {
-        auto value = cache.get(1);  // Returns "user1", noexcept
+    if (cache.Contains(1)) {
+        auto value = cache.Get(1);  // Returns "user1", noexcept
         std::cout << "User 1: " << value << " (noexcept access)\n";
     }
     
     // Safe access with fallback - no exceptions
-    auto value = cache.getOrDefault(999, "guest");  // Returns "guest"
+    auto value = cache.GetOrDefault(999, "guest");  // Returns "guest"
     std::cout << "User 999: " << value << " (safe fallback)\n";
     
     // Missing key with noexcept get() - returns default value
-    auto missing = cache.get(404);  // Returns "", no exception
+    auto missing = cache.Get(404);  // Returns "", no exception
     std::cout << "Missing key returns: '" << missing << "' (empty string)\n";
     
-    std::cout << "Cache size: " << cache.size() << " (noexcept)\n\n";
+    std::cout << "Cache size: " << cache.Size() << " (noexcept)\n\n";
 }
 
 void demonstrateErrorHandling() {
@@ -42,15 +42,15 @@ void demonstrateErrorHandling() {
     
     LFUCache<std::string, int, 100> cache;
     
-    cache.put("score1", 100);
-    cache.put("score2", 200);
+    cache.Put("score1", 100);
+    cache.Put("score2", 200);
     
     // When you need strict error handling
     try {
-        auto score = cache.getOrThrow("score1");  // Throws if not found
+        auto score = cache.GetOrThrow("score1");  // Throws if not found
         std::cout << "Score 1: " << score << " (validated access)\n";
         
-        auto missing = cache.getOrThrow("score999");  // Will throw
+        auto missing = cache.GetOrThrow("score999");  // Will throw
         std::cout << "This won't print\n";
     } catch (const std::runtime_error& e) {
         std::cout << "Caught expected exception: " << e.what() << "\n";
@@ -58,9 +58,9 @@ void demonstrateErrorHandling() {
     
     // Mixed usage - performance critical path with error handling
     for (const std::string& key : {"score1", "score2", "missing"}) {
-        if (cache.contains(key)) {
+        if (cache.Contains(key)) {
             // Hot path - noexcept
-            auto value = cache.get(key);
+            auto value = cache.Get(key);
             std::cout << key << ": " << value << " (fast path)\n";
         } else {
             std::cout << key << ": not found (checked first)\n";
@@ -76,7 +76,7 @@ void demonstratePerformanceCritical() {
     
     // Simulate high-frequency trading data
     for (int i = 1; i <= 100; ++i) {
-        cache.put(i, i * 3.14159);
+        cache.Put(i, i * 3.14159);
     }
     
     const int HOT_KEYS[] = {1, 5, 10, 25, 50};
@@ -86,13 +86,13 @@ void demonstratePerformanceCritical() {
     for (int iter = 0; iter < 10000; ++iter) {
         for (int key : HOT_KEYS) {
             // Ultra-fast access - no exception handling overhead
-            sum += cache.get(key);  // noexcept, maximum performance
+            sum += cache.Get(key);  // noexcept, maximum performance
         }
     }
     
     std::cout << "Processed 50,000 cache accesses (noexcept)\n";
     std::cout << "Total sum: " << sum << "\n";
-    std::cout << "Cache efficiency: " << cache.size() << "/" << cache.capacity() << "\n\n";
+    std::cout << "Cache efficiency: " << cache.Size() << "/" << cache.Capacity() << "\n\n";
 }
 
 void demonstrateMixedScenario() {
@@ -101,14 +101,14 @@ void demonstrateMixedScenario() {
     LFUCache<std::string, std::string, 200> cache;
     
     // Setup data
-    cache.put("config.timeout", "30");
-    cache.put("config.retries", "3");
-    cache.put("config.host", "localhost");
+    cache.Put("config.timeout", "30");
+    cache.Put("config.retries", "3");
+    cache.Put("config.host", "localhost");
     
     // Configuration reader - needs validation
     auto readConfig = [&cache](const std::string& key) -> std::string {
         try {
-            return cache.getOrThrow(key);  // Strict validation
+            return cache.GetOrThrow(key);  // Strict validation
         } catch (const std::runtime_error&) {
             throw std::runtime_error("Missing required config: " + key);
         }
@@ -116,7 +116,7 @@ void demonstrateMixedScenario() {
     
     // Hot path accessor - performance critical
     auto quickLookup = [&cache](const std::string& key, const std::string& defaultVal) -> std::string {
-        return cache.getOrDefault(key, defaultVal);  // noexcept, fast
+        return cache.GetOrDefault(key, defaultVal);  // noexcept, fast
     };
     
     try {
@@ -21,28 +21,28 @@ int main() {
     std::cout << "1. Basic Operations:\n";
     
     // Add some data
-    cache.put(1, "First");
-    cache.put(2, "Second");
-    cache.put(3, "Third");
+    cache.Put(1, "First");
+    cache.Put(2, "Second");
+    cache.Put(3, "Third");
     
-    std::cout << "   Added 3 items, cache size: " << cache.size() << "\n";
+    std::cout << "   Added 3 items, cache size: " << cache.Size() << "\n";
     
     // Access data (increases frequency)
-    std::cout << "   Key 1: " << cache.get(1) << " (noexcept access)\n";
-    std::cout << "   Key 2: " << cache.getOrDefault(2, "Not found") << "\n";
+    std::cout << "   Key 1: " << cache.Get(1) << " (noexcept access)\n";
+    std::cout << "   Key 2: " << cache.GetOrDefault(2, "Not found") << "\n";
     
     // Access key 1 again to increase its frequency
-    cache.get(1);
+    cache.Get(1);
     
     std::cout << "\n2. Error Handling:\n";
     
     // Safe access for missing keys
-    std::cout << "   Missing key (safe): '" << cache.get(999) << "' (empty string)\n";
-    std::cout << "   Missing key (fallback): " << cache.getOrDefault(999, "Default") << "\n";
+    std::cout << "   Missing key (safe): '" << cache.Get(999) << "' (empty string)\n";
+    std::cout << "   Missing key (fallback): " << cache.GetOrDefault(999, "Default") << "\n";
     
     // Exception-based access when needed
     try {
-        auto value = cache.getOrThrow(999);
+        auto value = cache.GetOrThrow(999);
         std::cout << "   This won't print\n";
     } catch (const std::runtime_error& e) {
         std::cout << "   Exception caught: " << e.what() << "\n";
@@ -52,23 +52,23 @@ int main() {
     
     // Fill cache to demonstrate LFU eviction
     for (int i = 4; i <= 503; ++i) {  // Will exceed capacity of 500
-        cache.put(i, "Item" + std::to_string(i));
+        cache.Put(i, "Item" + std::to_string(i));
     }
     
-    std::cout << "   After adding 500+ items, cache size: " << cache.size() << "\n";
-    std::cout << "   Cache capacity: " << cache.capacity() << "\n";
+    std::cout << "   After adding 500+ items, cache size: " << cache.Size() << "\n";
+    std::cout << "   Cache capacity: " << cache.Capacity() << "\n";
     
     // Check if frequently accessed items survived
     std::cout << "   Key 1 (accessed 3 times): ";
-    if (cache.contains(1)) {
-        std::cout << "Still in cache: " << cache.get(1) << "\n";
+    if (cache.Contains(1)) {
+        std::cout << "Still in cache: " << cache.Get(1) << "\n";
     } else {
         std::cout << "Evicted (LFU)\n";
     }
     
     std::cout << "   Key 3 (accessed 1 time): ";
-    if (cache.contains(3)) {
-        std::cout << "Still in cache: " << cache.get(3) << "\n";
+    if (cache.Contains(3)) {
+        std::cout << "Still in cache: " << cache.Get(3) << "\n";
     } else {
         std::cout << "Evicted (LFU)\n";
     }
@@ -82,8 +82,8 @@ int main() {
     
     for (int iter = 0; iter < 100000; ++iter) {
         for (int key : HOT_KEYS) {
-            if (cache.contains(key)) {           // noexcept
-                volatile auto value = cache.get(key);  // noexcept, maximum performance
+            if (cache.Contains(key)) {           // noexcept
+                volatile auto value = cache.Get(key);  // noexcept, maximum performance
                 (void)value;  // Prevent optimization
             }
         }
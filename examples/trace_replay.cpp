@@ -0,0 +1,515 @@
+/*
+ * Trace Replay
+ *
+ * Streams a recorded cache trace through LFUCache to predict hit ratio and
+ * throughput before changing capacity or policy. The trace is memory-mapped
+ * and parsed in small batches, and pages behind the reader are released as it
+ * advances, so resident memory stays flat for traces of hundreds of millions
+ * of accesses. Every capacity in --capacity replays from the same single pass.
+ *
+ * Trace formats (--trace-format):
+ *   text    One key per line. The first whitespace-separated token is the key;
+ *           decimal numbers are used as-is and anything else is hashed. Blank
+ *           lines and lines starting with '#' are skipped (LIRS traces, access logs).
+ *   arc     ARC-style "start_block block_count ignored request_id" lines; each
+ *           line expands to block_count consecutive block accesses.
+ *   binary  Packed little-endian uint64 keys, 8 bytes per access. Convert any
+ *           trace once with --write-binary to skip text parsing on later runs.
+ *
+ * Usage: ./trace_replay TRACE [--trace-format=text|arc|binary] [--capacity=N[,N...]]
+ *                       [--policy=lfu|lfu-da|w-tinylfu|lru|arc|s3-fifo|lirs]
+ *                       [--interval=N] [--limit=N] [--output=table|csv] [--write-binary=PATH]
+ */
+
+#include "lfu_cache.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef LFU_CACHE_HAS_MMAP
+#error "trace_replay requires POSIX mmap"
+#endif
+
+using TraceKey = uint64_t;
+
+static constexpr size_t BATCH_KEYS = 4096;
+static constexpr size_t RELEASE_BYTES = size_t{64} << 20;
+
+// Read-only mapping of a whole trace file
+class MappedTrace {
+public:
+    explicit MappedTrace(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "stat " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "map " + path);
+            }
+            base = static_cast<const char*>(address);
+            ::madvise(address, length, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        pageMask = static_cast<size_t>(::sysconf(_SC_PAGESIZE)) - 1;
+    }
+
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    ~MappedTrace() {
+        if (base != nullptr) {
+            ::munmap(const_cast<char*>(base), length);
+        }
+    }
+
+    const char* Begin() const noexcept { return base; }
+    const char* End() const noexcept { return base + length; }
+    size_t Size() const noexcept { return length; }
+
+    // Drops the pages before position once RELEASE_BYTES have been consumed, so a
+    // long trace does not stay resident behind the reader
+    void Release(const char* position) noexcept {
+        size_t offset = static_cast<size_t>(position - base) & ~pageMask;
+        if (offset >= released + RELEASE_BYTES) [[unlikely]] {
+            ::madvise(const_cast<char*>(base) + released, offset - released, MADV_DONTNEED);
+            released = offset;
+        }
+    }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    size_t released = 0;
+    size_t pageMask = 0;
+};
+
+inline bool isBlank(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r' || c == ',';
+}
+
+// Decimal tokens map to their value; anything else to its FNV-1a hash
+inline TraceKey tokenKey(const char* begin, const char* end) noexcept {
+    if (end - begin <= 19) {
+        TraceKey value = 0;
+        const char* p = begin;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + static_cast<TraceKey>(*p - '0');
+            ++p;
+        }
+        if (p == end) {
+            return value;
+        }
+    }
+    TraceKey hash = 0xcbf29ce484222325ULL;
+    for (const char* p = begin; p < end; ++p) {
+        hash = (hash ^ static_cast<unsigned char>(*p)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Parses the next unsigned decimal field of a line; false if there is none
+inline bool nextNumber(const char*& p, const char* end, TraceKey& value) noexcept {
+    while (p < end && isBlank(*p)) {
+        ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + static_cast<TraceKey>(*p - '0');
+        ++p;
+    }
+    return true;
+}
+
+class TextTraceReader {
+public:
+    explicit TextTraceReader(MappedTrace& mapped) : trace(mapped), cursor(mapped.Begin()), end(mapped.End()) {}
+
+    size_t Next(TraceKey* keys, size_t maxKeys) noexcept {
+        size_t count = 0;
+        while (count < maxKeys && cursor < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            const char* p = cursor;
+            cursor = lineEnd == end ? end : lineEnd + 1;
+            while (p < lineEnd && isBlank(*p)) {
+                ++p;
+            }
+            if (p == lineEnd || *p == '#') {
+                continue;
+            }
+            const char* tokenEnd = p;
+            while (tokenEnd < lineEnd && !isBlank(*tokenEnd)) {
+                ++tokenEnd;
+            }
+            keys[count++] = tokenKey(p, tokenEnd);
+        }
+        trace.Release(cursor);
+        return count;
+    }
+
+private:
+    MappedTrace& trace;
+    const char* cursor;
+    const char* end;
+};
+
+class ArcTraceReader {
+public:
+    explicit ArcTraceReader(MappedTrace& mapped) : trace(mapped), cursor(mapped.Begin()), end(mapped.End()) {}
+
+    size_t Next(TraceKey* keys, size_t maxKeys) noexcept {
+        size_t count = 0;
+        while (count < maxKeys) {
+            // A request can span several batches
+            if (remainingBlocks > 0) {
+                size_t blocks = std::min<size_t>(remainingBlocks, maxKeys - count);
+                for (size_t i = 0; i < blocks; ++i) {
+                    keys[count++] = nextBlock++;
+                }
+                remainingBlocks -= blocks;
+                continue;
+            }
+            if (cursor >= end) {
+                break;
+            }
+            const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+            if (lineEnd == nullptr) {
+                lineEnd = end;
+            }
+            const char* p = cursor;
+            cursor = lineEnd == end ? end : lineEnd + 1;
+            TraceKey start;
+            TraceKey blocks;
+            if (nextNumber(p, lineEnd, start) && nextNumber(p, lineEnd, blocks)) {
+                nextBlock = start;
+                remainingBlocks = blocks;
+            }
+        }
+        trace.Release(cursor);
+        return count;
+    }
+
+private:
+    MappedTrace& trace;
+    const char* cursor;
+    const char* end;
+    TraceKey nextBlock = 0;
+    TraceKey remainingBlocks = 0;
+};
+
+class BinaryTraceReader {
+public:
+    explicit BinaryTraceReader(MappedTrace& mapped) : trace(mapped), cursor(mapped.Begin()), end(mapped.End()) {
+        if (mapped.Size() % sizeof(TraceKey) != 0) {
+            throw std::runtime_error("binary trace size is not a multiple of 8 bytes");
+        }
+    }
+
+    size_t Next(TraceKey* keys, size_t maxKeys) noexcept {
+        size_t count = std::min<size_t>(maxKeys, static_cast<size_t>(end - cursor) / sizeof(TraceKey));
+        std::memcpy(keys, cursor, count * sizeof(TraceKey));
+        if constexpr (std::endian::native == std::endian::big) {
+            for (size_t i = 0; i < count; ++i) {
+                keys[i] = __builtin_bswap64(keys[i]);
+            }
+        }
+        cursor += count * sizeof(TraceKey);
+        trace.Release(cursor);
+        return count;
+    }
+
+private:
+    MappedTrace& trace;
+    const char* cursor;
+    const char* end;
+};
+
+struct Options {
+    std::string tracePath;
+    std::string traceFormat = "text";
+    std::vector<size_t> capacities = {100000};
+    std::string policy = "lfu";
+    uint64_t interval = 1000000;
+    uint64_t limit = std::numeric_limits<uint64_t>::max();
+    std::string output = "table";
+    std::string writeBinary;
+};
+
+// One simulated cache; the clock covers cache operations only, not trace parsing
+template<typename Admission, typename Eviction>
+struct CacheRun {
+    using Cache = DynamicLFUCache<TraceKey, uint32_t, std::hash<TraceKey>, Admission, std::equal_to<TraceKey>,
+                                  LFUNoEvictionListener, LFUUnitWeigher, LFUNoExpiry, LFUCountingStats, Eviction>;
+
+    explicit CacheRun(size_t capacity, bool dynamicAging) : cache(std::make_unique<Cache>(capacity)) {
+        if constexpr (!Eviction::ENABLED) {
+            cache->SetDynamicAging(dynamicAging);
+        }
+    }
+
+    void Replay(const TraceKey* keys, size_t count) noexcept {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            if (cache->Find(keys[i]) == nullptr) {
+                cache->Put(keys[i], 0u);
+            }
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::unique_ptr<Cache> cache;
+    double seconds = 0;
+    double intervalStartSeconds = 0;
+    LFUCacheStats intervalStart;
+};
+
+inline double ratio(uint64_t hits, uint64_t accesses) noexcept {
+    return accesses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(accesses);
+}
+
+template<typename Admission, typename Eviction, typename Reader>
+int replay(Reader& reader, const Options& options) {
+    std::vector<CacheRun<Admission, Eviction>> runs;
+    runs.reserve(options.capacities.size());
+    for (size_t capacity : options.capacities) {
+        runs.emplace_back(capacity, options.policy == "lfu-da");
+    }
+
+    bool csv = options.output == "csv";
+    if (csv) {
+        std::cout << "row,accesses,capacity,hit_ratio,interval_hit_ratio,evictions,ops_per_sec\n";
+    } else {
+        std::cout << "=== TRACE REPLAY ===\n";
+        std::cout << "Trace: " << options.tracePath << " (" << options.traceFormat << "), policy: " << options.policy
+                  << "\n\n";
+        std::cout << std::setw(14) << "accesses";
+        for (size_t capacity : options.capacities) {
+            std::cout << std::setw(24) << ("cap " + std::to_string(capacity) + " int/cum %");
+        }
+        std::cout << "\n";
+    }
+
+    std::vector<TraceKey> keys(BATCH_KEYS);
+    uint64_t accesses = 0;
+    uint64_t nextReport = options.interval;
+    auto wallStart = std::chrono::steady_clock::now();
+    while (accesses < options.limit) {
+        // Batches end exactly on report boundaries
+        uint64_t want = std::min<uint64_t>({BATCH_KEYS, nextReport - accesses, options.limit - accesses});
+        size_t count = reader.Next(keys.data(), static_cast<size_t>(want));
+        if (count == 0) {
+            break;
+        }
+        for (CacheRun<Admission, Eviction>& run : runs) {
+            run.Replay(keys.data(), count);
+        }
+        accesses += count;
+        if (accesses == nextReport) {
+            if (!csv) {
+                std::cout << std::setw(14) << accesses;
+            }
+            for (size_t i = 0; i < runs.size(); ++i) {
+                CacheRun<Admission, Eviction>& run = runs[i];
+                LFUCacheStats stats = run.cache->Statistics();
+                uint64_t intervalHits = stats.hits - run.intervalStart.hits;
+                uint64_t intervalAccesses = intervalHits + stats.misses - run.intervalStart.misses;
+                double intervalSeconds = run.seconds - run.intervalStartSeconds;
+                if (csv) {
+                    std::cout << "interval," << accesses << "," << options.capacities[i] << "," << std::fixed
+                              << std::setprecision(6) << stats.HitRatio() << ","
+                              << ratio(intervalHits, intervalAccesses) << "," << stats.evictions << ","
+                              << std::setprecision(0) << intervalAccesses / intervalSeconds << "\n";
+                } else {
+                    std::ostringstream cell;
+                    cell << std::fixed << std::setprecision(2) << ratio(intervalHits, intervalAccesses) * 100 << " / "
+                         << stats.HitRatio() * 100;
+                    std::cout << std::setw(24) << cell.str();
+                }
+                run.intervalStart = stats;
+                run.intervalStartSeconds = run.seconds;
+            }
+            if (!csv) {
+                std::cout << "\n";
+            }
+            nextReport += options.interval;
+        }
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    if (!csv) {
+        std::cout << "\n" << std::setw(12) << "capacity" << std::setw(14) << "accesses" << std::setw(14) << "hits"
+                  << std::setw(10) << "hit %" << std::setw(14) << "evictions" << std::setw(12) << "mean freq"
+                  << std::setw(14) << "ops/sec" << "\n";
+    }
+    for (size_t i = 0; i < runs.size(); ++i) {
+        LFUCacheStats stats = runs[i].cache->Statistics();
+        double opsPerSec = runs[i].seconds > 0 ? accesses / runs[i].seconds : 0.0;
+        if (csv) {
+            std::cout << "total," << accesses << "," << options.capacities[i] << "," << std::fixed
+                      << std::setprecision(6) << stats.HitRatio() << "," << stats.HitRatio() << "," << stats.evictions
+                      << "," << std::setprecision(0) << opsPerSec << "\n";
+        } else {
+            std::cout << std::setw(12) << options.capacities[i] << std::setw(14) << accesses << std::setw(14)
+                      << stats.hits << std::setw(10) << std::fixed << std::setprecision(2) << stats.HitRatio() * 100
+                      << std::setw(14) << stats.evictions << std::setw(12) << stats.MeanEvictedFrequency()
+                      << std::setw(14) << std::setprecision(0) << opsPerSec << "\n";
+        }
+    }
+    if (!csv) {
+        std::cout << "\nPass: " << std::fixed << std::setprecision(2) << wallSeconds << " s, " << std::setprecision(0)
+                  << accesses / std::max(wallSeconds, 1e-9) << " accesses/sec including trace parsing\n";
+    }
+    return 0;
+}
+
+// Rewrites any trace as the binary format
+template<typename Reader>
+int convert(Reader& reader, const Options& options) {
+    std::ofstream out(options.writeBinary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot open " << options.writeBinary << "\n";
+        return 1;
+    }
+    std::vector<TraceKey> keys(BATCH_KEYS);
+    uint64_t accesses = 0;
+    while (accesses < options.limit) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(BATCH_KEYS, options.limit - accesses));
+        size_t count = reader.Next(keys.data(), want);
+        if (count == 0) {
+            break;
+        }
+        if constexpr (std::endian::native == std::endian::big) {
+            for (size_t i = 0; i < count; ++i) {
+                keys[i] = __builtin_bswap64(keys[i]);
+            }
+        }
+        out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(count * sizeof(TraceKey)));
+        accesses += count;
+    }
+    if (!out.flush()) {
+        std::cerr << "Write to " << options.writeBinary << " failed\n";
+        return 1;
+    }
+    std::cout << "Wrote " << accesses << " accesses to " << options.writeBinary << "\n";
+    return 0;
+}
+
+template<typename Reader>
+int run(Reader& reader, const Options& options) {
+    if (!options.writeBinary.empty()) {
+        return convert(reader, options);
+    }
+    if (options.policy == "w-tinylfu") {
+        return replay<TinyLFUAdmission<>, LFUEviction>(reader, options);
+    }
+    if (options.policy == "lru") {
+        return replay<LFUAlwaysAdmit, LRUEviction>(reader, options);
+    }
+    if (options.policy == "arc") {
+        return replay<LFUAlwaysAdmit, ARCEviction>(reader, options);
+    }
+    if (options.policy == "s3-fifo") {
+        return replay<LFUAlwaysAdmit, S3FIFOEviction<>>(reader, options);
+    }
+    if (options.policy == "lirs") {
+        return replay<LFUAlwaysAdmit, LIRSEviction<>>(reader, options);
+    }
+    return replay<LFUAlwaysAdmit, LFUEviction>(reader, options);
+}
+
+static int usage(const char* program) {
+    std::cerr << "Usage: " << program << " TRACE [--trace-format=text|arc|binary] [--capacity=N[,N...]]\n"
+              << "       [--policy=lfu|lfu-da|w-tinylfu|lru|arc|s3-fifo|lirs]\n"
+              << "       [--interval=N] [--limit=N] [--output=table|csv] [--write-binary=PATH]\n";
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--trace-format=", 0) == 0) {
+                options.traceFormat = arg.substr(15);
+            } else if (arg.rfind("--capacity=", 0) == 0) {
+                options.capacities.clear();
+                std::string list = arg.substr(11);
+                for (size_t pos = 0; pos <= list.size();) {
+                    size_t comma = std::min(list.find(',', pos), list.size());
+                    options.capacities.push_back(std::stoull(list.substr(pos, comma - pos)));
+                    pos = comma + 1;
+                }
+            } else if (arg.rfind("--policy=", 0) == 0) {
+                options.policy = arg.substr(9);
+            } else if (arg.rfind("--interval=", 0) == 0) {
+                options.interval = std::stoull(arg.substr(11));
+            } else if (arg.rfind("--limit=", 0) == 0) {
+                options.limit = std::stoull(arg.substr(8));
+            } else if (arg.rfind("--output=", 0) == 0) {
+                options.output = arg.substr(9);
+            } else if (arg.rfind("--write-binary=", 0) == 0) {
+                options.writeBinary = arg.substr(15);
+            } else if (arg.rfind("--", 0) != 0 && options.tracePath.empty()) {
+                options.tracePath = arg;
+            } else {
+                return usage(argv[0]);
+            }
+        }
+    } catch (const std::exception&) {
+        return usage(argv[0]);
+    }
+    bool validPolicy = options.policy == "lfu" || options.policy == "lfu-da" || options.policy == "w-tinylfu"
+        || options.policy == "lru" || options.policy == "arc" || options.policy == "s3-fifo" || options.policy == "lirs";
+    bool validOutput = options.output == "table" || options.output == "csv";
+    bool validCapacities = std::all_of(options.capacities.begin(), options.capacities.end(),
+                                       [](size_t capacity) { return capacity > 0; });
+    if (options.tracePath.empty() || !validPolicy || !validOutput || !validCapacities || options.interval == 0) {
+        return usage(argv[0]);
+    }
+
+    try {
+        MappedTrace trace(options.tracePath);
+        if (options.traceFormat == "text") {
+            TextTraceReader reader(trace);
+            return run(reader, options);
+        }
+        if (options.traceFormat == "arc") {
+            ArcTraceReader reader(trace);
+            return run(reader, options);
+        }
+        if (options.traceFormat == "binary") {
+            BinaryTraceReader reader(trace);
+            return run(reader, options);
+        }
+        return usage(argv[0]);
+    } catch (const std::exception& e) {
+        std::cerr << "trace_replay: " << e.what() << "\n";
+        return 1;
+    }
+}
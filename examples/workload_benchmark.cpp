@@ -0,0 +1,228 @@
+/*
+ * Workload Benchmark
+ *
+ * Replays read-through traffic (TryGet, then Put on a miss) from parameterized
+ * workload generators against plain LFU, LFU-DA and W-TinyLFU caches and the
+ * LRU, ARC, S3-FIFO and LIRS eviction policies on the same pool and index, and
+ * reports throughput, hit ratio and Get/Put latency percentiles:
+ *
+ *   - Uniform and Zipfian keys (skew 0.6, 0.9, 0.99)
+ *   - A Zipfian hot set with sequential scans of never-repeated keys mixed in
+ *   - A loop slightly longer than the cache
+ *   - A Zipfian hot set replaced by fresh keys every quarter of the trace
+ *   - A value-size sweep (8 B to 4 KB) on the skew-0.99 trace
+ *
+ * Throughput and hit ratio come from an untimed pass (counters only); the
+ * percentiles from a second pass that times one operation in 8.
+ *
+ * Usage: ./workload_benchmark [--format=table|csv|json] [--ops=N] [--quick]
+ */
+
+#include "lfu_cache.h"
+#include "workload_generators.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr size_t CACHE_CAPACITY = 16384;
+static constexpr int KEY_SPACE = 16 * static_cast<int>(CACHE_CAPACITY);
+static constexpr unsigned LATENCY_SAMPLE_SHIFT = 3;
+
+template<size_t BYTES>
+struct Payload {
+    std::array<char, BYTES> bytes;
+};
+
+template<size_t VALUE_BYTES, typename Admission, typename Eviction, typename Stats>
+using BenchCache = LFUCache<uint32_t, Payload<VALUE_BYTES>, CACHE_CAPACITY, std::hash<uint32_t>, Admission,
+                            std::equal_to<uint32_t>, LFUNoEvictionListener, LFUUnitWeigher, LFUNoExpiry, Stats, Eviction>;
+
+struct Workload {
+    std::string name;
+    std::string parameters;
+    std::vector<uint32_t> trace;
+};
+
+struct Result {
+    std::string workload;
+    std::string parameters;
+    std::string policy;
+    size_t valueBytes;
+    size_t operations;
+    double opsPerSec;
+    double hitRatio;
+    uint64_t getP50, getP99, getP999;
+    uint64_t putP50, putP99, putP999;
+};
+
+template<typename CacheType, typename Value>
+void replay(CacheType& cache, const std::vector<uint32_t>& trace, const Value& payload) {
+    Value out{};
+    for (uint32_t key : trace) {
+        if (!cache.TryGet(key, out)) {
+            cache.Put(key, payload);
+        }
+    }
+    volatile char consume = out.bytes[0];
+    (void)consume;
+}
+
+template<typename CacheType>
+void configure(CacheType& cache, bool dynamicAging) {
+    if constexpr (requires { cache.SetDynamicAging(dynamicAging); }) {
+        cache.SetDynamicAging(dynamicAging);
+    }
+}
+
+template<size_t VALUE_BYTES, typename Admission, typename Eviction = LFUEviction>
+Result measure(const Workload& workload, const std::string& policy, bool dynamicAging) {
+    Payload<VALUE_BYTES> payload;
+    std::memset(payload.bytes.data(), 'v', VALUE_BYTES);
+    Result result{workload.name, workload.parameters, policy, VALUE_BYTES, workload.trace.size(), 0, 0, 0, 0, 0, 0, 0, 0};
+
+    {
+        auto cache = std::make_unique<BenchCache<VALUE_BYTES, Admission, Eviction, LFUCountingStats>>();
+        configure(*cache, dynamicAging);
+        auto start = std::chrono::steady_clock::now();
+        replay(*cache, workload.trace, payload);
+        auto end = std::chrono::steady_clock::now();
+        result.opsPerSec = workload.trace.size() / std::chrono::duration<double>(end - start).count();
+        result.hitRatio = cache->Statistics().HitRatio();
+    }
+
+    {
+        using TimedCache = BenchCache<VALUE_BYTES, Admission, Eviction, LFULatencyStats<LATENCY_SAMPLE_SHIFT>>;
+        auto cache = std::make_unique<TimedCache>();
+        configure(*cache, dynamicAging);
+        replay(*cache, workload.trace, payload);
+        LFULatencyHistogram gets = cache->Latency(LFUOperation::GetHit);
+        gets.Merge(cache->Latency(LFUOperation::GetMiss));
+        LFULatencyHistogram puts = cache->Latency(LFUOperation::PutInsert);
+        puts.Merge(cache->Latency(LFUOperation::PutEvict));
+        puts.Merge(cache->Latency(LFUOperation::PutUpdate));
+        result.getP50 = gets.Percentile(50);
+        result.getP99 = gets.Percentile(99);
+        result.getP999 = gets.Percentile(99.9);
+        result.putP50 = puts.Percentile(50);
+        result.putP99 = puts.Percentile(99);
+        result.putP999 = puts.Percentile(99.9);
+    }
+    return result;
+}
+
+template<size_t VALUE_BYTES>
+void measurePolicies(const Workload& workload, std::vector<Result>& results) {
+    results.push_back(measure<VALUE_BYTES, LFUAlwaysAdmit>(workload, "lfu", false));
+    results.push_back(measure<VALUE_BYTES, LFUAlwaysAdmit>(workload, "lfu-da", true));
+    results.push_back(measure<VALUE_BYTES, TinyLFUAdmission<>>(workload, "w-tinylfu", false));
+    results.push_back(measure<VALUE_BYTES, LFUAlwaysAdmit, LRUEviction>(workload, "lru", false));
+    results.push_back(measure<VALUE_BYTES, LFUAlwaysAdmit, ARCEviction>(workload, "arc", false));
+    results.push_back(measure<VALUE_BYTES, LFUAlwaysAdmit, S3FIFOEviction<>>(workload, "s3-fifo", false));
+    results.push_back(measure<VALUE_BYTES, LFUAlwaysAdmit, LIRSEviction<>>(workload, "lirs", false));
+}
+
+void printTable(const std::vector<Result>& results) {
+    std::cout << "=== WORKLOAD BENCHMARK ===\n";
+    std::cout << "Capacity: " << CACHE_CAPACITY << ", key space: " << KEY_SPACE
+              << ", read-through (TryGet, Put on miss), latency sampled 1 in " << (1u << LATENCY_SAMPLE_SHIFT) << "\n\n";
+    std::cout << std::left << std::setw(10) << "workload" << std::setw(36) << "parameters" << std::setw(11) << "policy"
+              << std::right << std::setw(7) << "value" << std::setw(12) << "ops/sec" << std::setw(8) << "hit %"
+              << std::setw(22) << "get p50/p99/p99.9 ns" << std::setw(22) << "put p50/p99/p99.9 ns" << "\n";
+    for (const Result& r : results) {
+        std::string get = std::to_string(r.getP50) + "/" + std::to_string(r.getP99) + "/" + std::to_string(r.getP999);
+        std::string put = std::to_string(r.putP50) + "/" + std::to_string(r.putP99) + "/" + std::to_string(r.putP999);
+        std::cout << std::left << std::setw(10) << r.workload << std::setw(36) << r.parameters << std::setw(11) << r.policy
+                  << std::right << std::setw(7) << r.valueBytes << std::setw(12) << std::fixed << std::setprecision(0)
+                  << r.opsPerSec << std::setw(8) << std::setprecision(2) << r.hitRatio * 100
+                  << std::setw(22) << get << std::setw(22) << put << "\n";
+    }
+}
+
+void printCsv(const std::vector<Result>& results) {
+    std::cout << "workload,parameters,policy,value_bytes,operations,ops_per_sec,hit_ratio,"
+                 "get_p50_ns,get_p99_ns,get_p999_ns,put_p50_ns,put_p99_ns,put_p999_ns\n";
+    for (const Result& r : results) {
+        std::cout << r.workload << ",\"" << r.parameters << "\"," << r.policy << "," << r.valueBytes << ","
+                  << r.operations << "," << std::fixed << std::setprecision(0) << r.opsPerSec << ","
+                  << std::setprecision(6) << r.hitRatio << "," << r.getP50 << "," << r.getP99 << "," << r.getP999
+                  << "," << r.putP50 << "," << r.putP99 << "," << r.putP999 << "\n";
+    }
+}
+
+void printJson(const std::vector<Result>& results) {
+    std::cout << "{\n  \"capacity\": " << CACHE_CAPACITY << ",\n  \"key_space\": " << KEY_SPACE
+              << ",\n  \"latency_sample_rate\": " << (1u << LATENCY_SAMPLE_SHIFT) << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::cout << "    {\"workload\": \"" << r.workload << "\", \"parameters\": \"" << r.parameters
+                  << "\", \"policy\": \"" << r.policy << "\", \"value_bytes\": " << r.valueBytes
+                  << ", \"operations\": " << r.operations << ", \"ops_per_sec\": " << std::fixed
+                  << std::setprecision(0) << r.opsPerSec << ", \"hit_ratio\": " << std::setprecision(6) << r.hitRatio
+                  << ", \"get_ns\": {\"p50\": " << r.getP50 << ", \"p99\": " << r.getP99 << ", \"p999\": " << r.getP999
+                  << "}, \"put_ns\": {\"p50\": " << r.putP50 << ", \"p99\": " << r.putP99 << ", \"p999\": " << r.putP999
+                  << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    std::string format = "table";
+    size_t operations = 2000000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--format=", 0) == 0) {
+            format = arg.substr(9);
+        } else if (arg.rfind("--ops=", 0) == 0) {
+            operations = std::stoul(arg.substr(6));
+        } else if (arg == "--quick") {
+            operations = 200000;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--format=table|csv|json] [--ops=N] [--quick]\n";
+            return 1;
+        }
+    }
+    if (format != "table" && format != "csv" && format != "json") {
+        std::cerr << "Unknown format: " << format << "\n";
+        return 1;
+    }
+
+    const int loopLength = static_cast<int>(CACHE_CAPACITY + CACHE_CAPACITY / 4);
+    const int scanLength = static_cast<int>(2 * CACHE_CAPACITY);
+    std::vector<Workload> workloads;
+    workloads.push_back({"uniform", "keys=" + std::to_string(KEY_SPACE), uniformTrace(operations, KEY_SPACE, 1)});
+    for (double skew : {0.6, 0.9, 0.99}) {
+        std::string theta = std::to_string(skew).substr(0, 4);
+        workloads.push_back({"zipf", "theta=" + theta, zipfianTrace(operations, KEY_SPACE, skew, 2)});
+    }
+    workloads.push_back({"scan", "theta=0.9 every=50000 len=" + std::to_string(scanLength),
+                         scanTrace(operations, KEY_SPACE, 0.9, 50000, scanLength, 3)});
+    workloads.push_back({"loop", "len=" + std::to_string(loopLength), loopTrace(operations, loopLength)});
+    workloads.push_back({"shifting", "theta=0.9 phases=4",
+                         shiftingTrace(operations, KEY_SPACE, 0.9, std::max<size_t>(1, operations / 4), 4)});
+
+    std::vector<Result> results;
+    for (const Workload& workload : workloads) {
+        measurePolicies<64>(workload, results);
+    }
+
+    // Value-size sweep on the most skewed trace
+    const Workload& sweep = workloads[3];
+    measurePolicies<8>(sweep, results);
+    measurePolicies<512>(sweep, results);
+    measurePolicies<4096>(sweep, results);
+
+    if (format == "csv") {
+        printCsv(results);
+    } else if (format == "json") {
+        printJson(results);
+    } else {
+        printTable(results);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Workload Generators
+ *
+ * Key-trace generators shared by the benchmarks. Every generator returns a
+ * pre-built trace so RNG cost stays out of timed regions. Keys are scrambled
+ * with a multiplicative hash so that popular ranks do not cluster in one
+ * shard or index region.
+ */
+
+#ifndef WORKLOAD_GENERATORS_H
+#define WORKLOAD_GENERATORS_H
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Zipfian generator (Gray et al., "Quickly Generating Billion-Record Synthetic
+// Databases"): O(1) per sample after computing zeta(n) once. Rank 0 is hottest.
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(int itemCount, double skew)
+        : items(itemCount), theta(skew), zetaN(zeta(itemCount, skew)) {
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / items, 1.0 - theta)) / (1.0 - zeta(2, theta) / zetaN);
+    }
+
+    template<typename Rng>
+    int operator()(Rng& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetaN;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta)) {
+            return 1;
+        }
+        return static_cast<int>(items * std::pow(eta * u - eta + 1.0, alpha));
+    }
+
+private:
+    static double zeta(int n, double skew) {
+        double sum = 0;
+        for (int i = 1; i <= n; ++i) {
+            sum += 1.0 / std::pow(i, skew);
+        }
+        return sum;
+    }
+
+    int items;
+    double theta;
+    double zetaN;
+    double alpha;
+    double eta;
+};
+
+// Bijective scramble of a rank within [0, 2^32)
+inline uint32_t scrambleKey(uint32_t rank) {
+    return rank * 2654435761u;
+}
+
+// Uniform keys over keySpace
+inline std::vector<uint32_t> uniformTrace(size_t length, int keySpace, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> uniform(0, keySpace - 1);
+    std::vector<uint32_t> trace(length);
+    for (uint32_t& key : trace) {
+        key = scrambleKey(static_cast<uint32_t>(uniform(rng)));
+    }
+    return trace;
+}
+
+// Zipfian keys over keySpace with the given skew (theta in [0, 1); 0.99 is YCSB's default)
+inline std::vector<uint32_t> zipfianTrace(size_t length, int keySpace, double skew, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    ZipfianGenerator zipf(keySpace, skew);
+    std::vector<uint32_t> trace(length);
+    for (uint32_t& key : trace) {
+        key = scrambleKey(static_cast<uint32_t>(zipf(rng)));
+    }
+    return trace;
+}
+
+// Zipfian hot set interrupted every scanEvery accesses by a sequential scan of
+// scanLength keys that are never seen again
+inline std::vector<uint32_t> scanTrace(size_t length, int keySpace, double skew, int scanEvery, int scanLength,
+                                       unsigned seed) {
+    std::mt19937_64 rng(seed);
+    ZipfianGenerator zipf(keySpace, skew);
+    std::vector<uint32_t> trace;
+    trace.reserve(length);
+    uint32_t nextColdRank = static_cast<uint32_t>(keySpace);
+    while (trace.size() < length) {
+        for (int i = 0; i < scanEvery && trace.size() < length; ++i) {
+            trace.push_back(scrambleKey(static_cast<uint32_t>(zipf(rng))));
+        }
+        for (int i = 0; i < scanLength && trace.size() < length; ++i) {
+            trace.push_back(scrambleKey(nextColdRank++));
+        }
+    }
+    return trace;
+}
+
+// The same loopLength keys accessed cyclically; a loop longer than the cache defeats
+// recency and is where frequency-based eviction keeps a stable subset
+inline std::vector<uint32_t> loopTrace(size_t length, int loopLength) {
+    std::vector<uint32_t> trace(length);
+    for (size_t i = 0; i < length; ++i) {
+        trace[i] = scrambleKey(static_cast<uint32_t>(i % static_cast<size_t>(loopLength)));
+    }
+    return trace;
+}
+
+// Zipfian accesses whose hot set is replaced by keySpace fresh keys every phaseLength
+// accesses, so counts built up in one phase become stale in the next
+inline std::vector<uint32_t> shiftingTrace(size_t length, int keySpace, double skew, size_t phaseLength,
+                                           unsigned seed) {
+    std::mt19937_64 rng(seed);
+    ZipfianGenerator zipf(keySpace, skew);
+    std::vector<uint32_t> trace(length);
+    for (size_t i = 0; i < length; ++i) {
+        uint32_t phase = static_cast<uint32_t>(i / phaseLength);
+        trace[i] = scrambleKey(static_cast<uint32_t>(zipf(rng)) + phase * static_cast<uint32_t>(keySpace));
+    }
+    return trace;
+}
+
+#endif // WORKLOAD_GENERATORS_H
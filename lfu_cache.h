@@ -14,281 +14,3373 @@
 #define LFU_CACHE_H
 
 #include <iostream>
-#include <unordered_map>
 #include <vector>
 #include <array>
 #include <cassert>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <random>
 #include <algorithm>
 #include <numeric>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <stdexcept>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
 
-template<typename Key, typename Value, size_t MAX_SIZE, typename Hash = std::hash<Key>>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LFU_CACHE_HAS_MMAP 1
+#endif
+
+// Uninitialized, suitably aligned storage for N objects. Nothing is constructed (or
+// touched) up front; elements are constructed in place when a slot is first used.
+template<typename T, size_t N>
+struct LFURawArray {
+    alignas(T) std::byte bytes[sizeof(T) * N];
+    
+    inline T& operator[](size_t i) noexcept {
+        return *std::launder(reinterpret_cast<T*>(bytes + i * sizeof(T)));
+    }
+    inline const T& operator[](size_t i) const noexcept {
+        return *std::launder(reinterpret_cast<const T*>(bytes + i * sizeof(T)));
+    }
+};
+
+// Software prefetch hint for batched lookups; a no-op where the builtin is unavailable
+inline void LFUPrefetch(const void* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 1, 3);
+#else
+    (void)address;
+#endif
+}
+
+// Pass as MAX_SIZE to size the cache at runtime (see DynamicLFUCache)
+inline constexpr size_t LFU_DYNAMIC_CAPACITY = std::numeric_limits<size_t>::max();
+
+// One zero-filled, cache-line aligned allocation backing a runtime-capacity cache.
+// Anonymous mappings are used where available so pages are committed only when
+// first touched; huge pages are requested explicitly (MAP_HUGETLB) and fall back
+// to transparent huge pages when no reserved huge pages are available.
+class LFUHeapRegion {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+    
+    LFUHeapRegion() noexcept = default;
+    
+    LFUHeapRegion(size_t bytes, bool useHugePages) : size(bytes) {
+#ifdef LFU_CACHE_HAS_MMAP
+#ifdef MAP_HUGETLB
+        if (useHugePages) {
+            size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+            void* ptr = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (ptr != MAP_FAILED) {
+                data = ptr;
+                size = rounded;
+                hugePages = true;
+                return;
+            }
+        }
+#endif
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        data = ptr;
+#ifdef MADV_HUGEPAGE
+        if (useHugePages) {
+            hugePages = madvise(ptr, bytes, MADV_HUGEPAGE) == 0;
+        }
+#endif
+#else
+        (void)useHugePages;
+        data = ::operator new(bytes, std::align_val_t{ALIGNMENT});
+        std::memset(data, 0, bytes);
+#endif
+    }
+    
+    ~LFUHeapRegion() { release(); }
+    
+    LFUHeapRegion(LFUHeapRegion&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)),
+          hugePages(std::exchange(other.hugePages, false)) {}
+    
+    LFUHeapRegion& operator=(LFUHeapRegion&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+            hugePages = std::exchange(other.hugePages, false);
+        }
+        return *this;
+    }
+    
+    inline std::byte* Data() const noexcept { return static_cast<std::byte*>(data); }
+    inline size_t Bytes() const noexcept { return size; }
+    inline bool HugePages() const noexcept { return hugePages; }
+    
+private:
+    void release() noexcept {
+        if (!data) {
+            return;
+        }
+#ifdef LFU_CACHE_HAS_MMAP
+        munmap(data, size);
+#else
+        ::operator delete(data, std::align_val_t{ALIGNMENT});
+#endif
+        data = nullptr;
+    }
+    
+    void* data = nullptr;
+    size_t size = 0;
+    bool hugePages = false;
+};
+
+// Open-addressing key index over a node pool.
+//
+// Each slot holds a 32-bit hash fragment and a 1-based pool index (0 = empty),
+// so a lookup scans a handful of 8-byte slots in one or two cache lines and
+// only dereferences a node when the hash fragment matches. Linear probing with
+// backward-shift deletion keeps the table free of tombstones, and the table is
+// sized once from the pool capacity, so it never allocates or rehashes. With
+// LFU_DYNAMIC_CAPACITY the slots live in caller-provided zeroed memory instead.
+template<size_t CAPACITY>
+class LFUFlatIndex {
+public:
+    struct Slot {
+        uint32_t hash;   // Mixed hash fragment (also determines the home slot)
+        uint32_t node;   // Pool index + 1, 0 marks an empty slot
+    };
+    
+    static constexpr bool IS_DYNAMIC = CAPACITY == LFU_DYNAMIC_CAPACITY;
+    static constexpr size_t MAX_CAPACITY = (size_t{1} << 31) - 2;
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+    
+    // OPTIMIZATION: Constant folding - load factor <= 0.5 keeps probe sequences short
+    static constexpr size_t SlotsFor(size_t capacity) noexcept { return std::bit_ceil(capacity * 2); }
+    static constexpr size_t SLOT_COUNT = IS_DYNAMIC ? 0 : SlotsFor(CAPACITY);
+    
+    static_assert(IS_DYNAMIC || CAPACITY <= MAX_CAPACITY, "LFUFlatIndex supports at most 2^31 - 2 entries");
+    
+    LFUFlatIndex() noexcept : slotMask(SLOT_COUNT - 1) {
+        if constexpr (!IS_DYNAMIC) {
+            slots.fill(Slot{0, 0});
+        }
+    }
+    
+    // Runtime-capacity tables use zero-filled external memory of SlotsFor(capacity) slots
+    void Attach(Slot* memory, size_t slotCount) noexcept requires IS_DYNAMIC {
+        slots = memory;
+        slotMask = slotCount - 1;
+    }
+    
+    // Spread the user hash over all bits; std::hash<int> is the identity on most platforms
+    static inline uint32_t Mix(size_t hash) noexcept {
+        uint64_t h = static_cast<uint64_t>(hash);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<uint32_t>(h);
+    }
+    
+    // Returns the pool index of the matching entry or NOT_FOUND
+    template<typename Matches>
+    inline uint32_t Find(uint32_t hash, Matches&& matches) const noexcept {
+        const size_t wrap = mask();
+        size_t pos = hash & wrap;
+        while (true) {
+            const Slot& slot = slots[pos];
+            if (slot.node == 0) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+                return NOT_FOUND;
+            }
+            if (slot.hash == hash && matches(slot.node - 1)) [[likely]] {
+                return slot.node - 1;
+            }
+            pos = (pos + 1) & wrap;
+        }
+    }
+    
+    // Batched lookups: start loading the home slot of a hash
+    inline void Prefetch(uint32_t hash) const noexcept {
+        LFUPrefetch(&slots[hash & mask()]);
+    }
+    
+    // First pool index in the probe run whose hash fragment matches, or NOT_FOUND.
+    // Does not compare keys, so callers may use it to prefetch the likely node.
+    inline uint32_t Candidate(uint32_t hash) const noexcept {
+        const size_t wrap = mask();
+        size_t pos = hash & wrap;
+        while (slots[pos].node != 0) {
+            if (slots[pos].hash == hash) {
+                return slots[pos].node - 1;
+            }
+            pos = (pos + 1) & wrap;
+        }
+        return NOT_FOUND;
+    }
+    
+    // Caller guarantees the key is not present and the table is not full
+    inline void Insert(uint32_t hash, uint32_t node) noexcept {
+        const size_t wrap = mask();
+        size_t pos = hash & wrap;
+        while (slots[pos].node != 0) {
+            pos = (pos + 1) & wrap;
+        }
+        slots[pos] = Slot{hash, node + 1};
+    }
+    
+    // Removes the slot referring to the given pool index
+    inline void Erase(uint32_t hash, uint32_t node) noexcept {
+        const size_t wrap = mask();
+        size_t pos = hash & wrap;
+        while (slots[pos].node != node + 1) {
+            assert(slots[pos].node != 0 && "Erasing an entry that is not indexed");
+            pos = (pos + 1) & wrap;
+        }
+        
+        // Backward-shift deletion: pull later entries of the cluster into the hole
+        size_t hole = pos;
+        size_t next = (pos + 1) & wrap;
+        while (slots[next].node != 0) {
+            size_t home = slots[next].hash & wrap;
+            // Move the entry unless its home lies cyclically in (hole, next]
+            if (((next - home) & wrap) >= ((next - hole) & wrap)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+            next = (next + 1) & wrap;
+        }
+        slots[hole] = Slot{0, 0};
+    }
+    
+    void Clear() noexcept { std::fill_n(&slots[0], slotMask + 1, Slot{0, 0}); }
+    
+private:
+    // OPTIMIZATION: Constant folding - the mask is a compile-time constant for fixed tables
+    inline size_t mask() const noexcept {
+        if constexpr (IS_DYNAMIC) {
+            return slotMask;
+        } else {
+            return SLOT_COUNT - 1;
+        }
+    }
+    
+    std::conditional_t<IS_DYNAMIC, Slot*, std::array<Slot, SLOT_COUNT>> slots;
+    size_t slotMask;
+};
+
+// Default eviction listener: evicted entries are simply destroyed. A custom listener sets
+// ENABLED = true and provides
+//     void OnEvict(Key&& key, Value&& value) noexcept;
+// which receives every entry removed to make room or because it expired (including W-TinyLFU
+// rejections, but not Clear() or overwrites) with key and value moved out, e.g. to write
+// dirty values back or to recycle their buffers. It runs inside Put() and must not call
+// back into the cache.
+struct LFUNoEvictionListener {
+    static constexpr bool ENABLED = false;
+};
+
+// Default weigher: capacity is an entry count only. A custom weigher sets ENABLED = true
+// and provides
+//     size_t operator()(const Key& key, const Value& value) const noexcept;
+// returning the entry's cost (e.g. its size in bytes), which is charged against the
+// budget set with SetMaxWeight(). It is called once per insert or overwrite.
+struct LFUUnitWeigher {
+    static constexpr bool ENABLED = false;
+};
+
+// Point-in-time copy of a cache's counters (see LFUCountingStats)
+struct LFUCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;            // Including reads of expired entries
+    uint64_t inserts = 0;           // New keys, whether or not TinyLFU later admits them
+    uint64_t updates = 0;           // Overwrites of existing keys
+    uint64_t evictions = 0;         // Entries removed to make room (incl. TinyLFU rejections)
+    uint64_t expirations = 0;       // Entries removed because their TTL passed
+    uint64_t evictedFrequencySum = 0;
+    // Frequency at eviction, log2 buckets: [b] counts victims with bit_width(frequency) == b
+    // (0 for window entries, which never reached a frequency bucket, and for caches with an
+    // Eviction policy, which keep no frequencies)
+    std::array<uint64_t, 32> evictedFrequency{};
+    
+    inline double HitRatio() const noexcept {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+    
+    inline double MeanEvictedFrequency() const noexcept {
+        return evictions == 0 ? 0.0 : static_cast<double>(evictedFrequencySum) / static_cast<double>(evictions);
+    }
+    
+    LFUCacheStats& operator+=(const LFUCacheStats& other) noexcept {
+        hits += other.hits;
+        misses += other.misses;
+        inserts += other.inserts;
+        updates += other.updates;
+        evictions += other.evictions;
+        expirations += other.expirations;
+        evictedFrequencySum += other.evictedFrequencySum;
+        for (size_t b = 0; b < evictedFrequency.size(); ++b) {
+            evictedFrequency[b] += other.evictedFrequency[b];
+        }
+        return *this;
+    }
+};
+
+// Default statistics policy: nothing is counted and no code is generated
+struct LFUNoStats {
+    static constexpr bool ENABLED = false;
+    static constexpr bool TIMED = false;
+};
+
+// Plain (non-atomic) counters updated inline by the cache. A ShardedLFUCache keeps one
+// set per shard, updated under the shard lock on the shard's own cache lines, and sums
+// them on read, so concurrent use needs no atomics either.
+struct LFUCountingStats {
+    static constexpr bool ENABLED = true;
+    static constexpr bool TIMED = false;
+    
+    inline void RecordHit() noexcept { ++counters.hits; }
+    inline void RecordMiss() noexcept { ++counters.misses; }
+    inline void RecordInsert() noexcept { ++counters.inserts; }
+    inline void RecordUpdate() noexcept { ++counters.updates; }
+    inline void RecordExpiration() noexcept { ++counters.expirations; }
+    
+    inline void RecordEviction(int frequency) noexcept {
+        ++counters.evictions;
+        counters.evictedFrequencySum += static_cast<uint64_t>(frequency);
+        ++counters.evictedFrequency[std::bit_width(static_cast<uint32_t>(frequency))];
+    }
+    
+    inline const LFUCacheStats& Snapshot() const noexcept { return counters; }
+    inline void Reset() noexcept { counters = LFUCacheStats{}; }
+    
+private:
+    LFUCacheStats counters;
+};
+
+// Operation classes timed by LFULatencyStats. Gets are timed through the lookup; Puts and
+// Emplaces are split into overwrites, inserts with room, and inserts into a full cache.
+enum class LFUOperation : uint8_t { GetHit, GetMiss, PutUpdate, PutInsert, PutEvict, COUNT };
+
+// Log-linear latency histogram in nanoseconds: exact below 32 ns, then 16 sub-buckets per
+// power of two (at most 1/16 relative error) up to 2^32 ns, above which values saturate.
+// Histograms from different caches, shards or threads combine with Merge().
+class LFULatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr uint64_t SUB_COUNT = uint64_t{1} << SUB_BITS;
+    static constexpr uint64_t MAX_VALUE = (uint64_t{1} << 32) - 1;
+    static constexpr size_t BUCKETS = (32 - SUB_BITS) * SUB_COUNT + 2 * SUB_COUNT;
+    
+    inline void Record(uint64_t nanoseconds) noexcept {
+        ++counts[indexOf(std::min(nanoseconds, MAX_VALUE))];
+        ++total;
+        maximum = std::max(maximum, nanoseconds);
+    }
+    
+    void Merge(const LFULatencyHistogram& other) noexcept {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        maximum = std::max(maximum, other.maximum);
+    }
+    
+    // Upper bound of the bucket holding the given percentile (0-100), or 0 when empty
+    uint64_t Percentile(double percentile) const noexcept {
+        if (total == 0) {
+            return 0;
+        }
+        double clamped = std::clamp(percentile, 0.0, 100.0);
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(upperBound(i), maximum);
+            }
+        }
+        return maximum;
+    }
+    
+    inline uint64_t Count() const noexcept { return total; }
+    inline uint64_t Max() const noexcept { return maximum; }
+    
+    void Reset() noexcept {
+        counts.fill(0);
+        total = 0;
+        maximum = 0;
+    }
+    
+private:
+    static inline size_t indexOf(uint64_t value) noexcept {
+        if (value < 2 * SUB_COUNT) {
+            return static_cast<size_t>(value);
+        }
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - SUB_BITS - 1;
+        return static_cast<size_t>(shift * SUB_COUNT + (value >> shift));
+    }
+    
+    static inline uint64_t upperBound(size_t index) noexcept {
+        if (index < 2 * SUB_COUNT) {
+            return index;
+        }
+        uint64_t shift = index / SUB_COUNT - 1;
+        uint64_t lower = (index % SUB_COUNT + SUB_COUNT) << shift;
+        return lower + (uint64_t{1} << shift) - 1;
+    }
+    
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    uint64_t maximum = 0;
+};
+
+// LFUCountingStats plus a latency histogram per LFUOperation. One operation in
+// 2^SAMPLE_SHIFT is timed (all of them with 0), so production builds can keep it on at a
+// small cost: an unsampled operation pays one counter increment and branch. Clock reads
+// use Clock (std::chrono::steady_clock, a vDSO call on Linux, by default).
+template<unsigned SAMPLE_SHIFT = 0, typename Clock = std::chrono::steady_clock>
+struct LFULatencyStats : LFUCountingStats {
+    static constexpr bool TIMED = true;
+    
+    // Start time of a sampled operation, or 0 for one that is not timed
+    inline uint64_t StartTimer() noexcept {
+        if constexpr (SAMPLE_SHIFT > 0) {
+            if ((++sampleCounter & ((uint64_t{1} << SAMPLE_SHIFT) - 1)) != 0) [[likely]] {
+                return 0;
+            }
+        }
+        return now();
+    }
+    
+    inline void RecordLatency(LFUOperation operation, uint64_t start) noexcept {
+        if (start != 0) {
+            histograms[static_cast<size_t>(operation)].Record(now() - start);
+        }
+    }
+    
+    inline const LFULatencyHistogram& Latency(LFUOperation operation) const noexcept {
+        return histograms[static_cast<size_t>(operation)];
+    }
+    
+    void Reset() noexcept {
+        LFUCountingStats::Reset();
+        for (LFULatencyHistogram& histogram : histograms) {
+            histogram.Reset();
+        }
+    }
+    
+private:
+    static inline uint64_t now() noexcept {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count())
+            | 1;  // Never 0, which marks an operation that is not timed
+    }
+    
+    std::array<LFULatencyHistogram, static_cast<size_t>(LFUOperation::COUNT)> histograms{};
+    uint64_t sampleCounter = 0;
+};
+
+// Key and value types SaveSnapshot()/LoadSnapshot() can serialize: raw bytes for trivially
+// copyable types, a length prefix and characters for std::string
+template<typename T>
+concept LFUSnapshotField = std::is_trivially_copyable_v<T> || std::is_same_v<T, std::string>;
+
+// Default expiry policy: entries never expire
+struct LFUNoExpiry {
+    static constexpr bool ENABLED = false;
+};
+
+// Time-to-live support. Entries get a deadline in whole Ticks of Clock (the default TTL,
+// or one given to PutWithTTL()). Expired entries read as misses and are removed lazily on
+// lookup, and a hierarchical timer wheel reclaims the rest before any LFU eviction.
+template<typename Clock = std::chrono::steady_clock, typename Tick = std::chrono::milliseconds>
+struct LFUTimerWheelExpiry {
+    static constexpr bool ENABLED = true;
+    using ClockType = Clock;
+    using TickType = Tick;
+    
+    static inline uint64_t Now() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<Tick>(Clock::now().time_since_epoch()).count());
+    }
+    
+    // TTLs round up to whole ticks; a zero TTL means "never expires"
+    template<typename Rep, typename Period>
+    static inline uint64_t Ticks(std::chrono::duration<Rep, Period> ttl) noexcept {
+        return ttl.count() <= 0 ? 0 : static_cast<uint64_t>(std::chrono::ceil<Tick>(ttl).count());
+    }
+};
+
+// Transparent hash for std::string keys: hashes anything convertible to std::string_view
+// (string literals, std::string_view, std::string) without building a std::string.
+// Pair with std::equal_to<> as KeyEqual to enable heterogeneous lookups.
+struct LFUStringHash {
+    using is_transparent = void;
+    
+    inline size_t operator()(std::string_view key) const noexcept {
+        return std::hash<std::string_view>{}(key);
+    }
+};
+
+// Lookups by a type other than Key need both the hash and the key equality to opt in
+template<typename Hash, typename KeyEqual>
+concept LFUTransparentLookup = requires {
+    typename Hash::is_transparent;
+    typename KeyEqual::is_transparent;
+};
+
+// Default admission policy: every new key is admitted and the LFU victim is evicted
+struct LFUAlwaysAdmit {
+    static constexpr bool ENABLED = false;
+};
+
+// W-TinyLFU admission policy.
+//
+// New keys first enter a small LRU window (WINDOW_PERCENT of the capacity). When the
+// window overflows, its LRU entry competes with the main region's LFU victim and only
+// displaces it if a count-min sketch estimates the newcomer to be more popular, so a
+// one-off scan cannot flush the main region. The sketch keeps four 4-bit counters per
+// key in 64-bit words sized from the capacity at construction, and halves every counter
+// after SAMPLE_MULTIPLIER * capacity recorded accesses so old popularity fades.
+template<size_t WINDOW_PERCENT = 1>
+class TinyLFUAdmission {
+public:
+    static constexpr bool ENABLED = true;
+    static constexpr size_t SAMPLE_MULTIPLIER = 10;
+    static constexpr uint64_t RESET_MASK = 0x7777777777777777ULL;
+    static constexpr uint64_t SEEDS[4] = {
+        0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+    };
+    
+    static_assert(WINDOW_PERCENT > 0 && WINDOW_PERCENT < 100, "WINDOW_PERCENT must be in (0, 100)");
+    
+    // Sizes the sketch once; called by the cache constructor
+    void Reset(size_t capacity) {
+        table.assign(std::bit_ceil(std::max<size_t>(capacity, 16)), 0);
+        counterMask = table.size() * 16 - 1;
+        sampleLimit = capacity * SAMPLE_MULTIPLIER;
+        samples = 0;
+    }
+    
+    static constexpr size_t WindowCapacity(size_t capacity) noexcept {
+        return std::max<size_t>(1, capacity * WINDOW_PERCENT / 100);
+    }
+    
+    // Counts one access to the key with the given (mixed) hash
+    inline void Record(uint32_t hash) noexcept {
+        bool added = false;
+        for (int i = 0; i < 4; ++i) {
+            size_t counter = counterOf(hash, i);
+            uint64_t& word = table[counter >> 4];
+            int shift = static_cast<int>(counter & 15) << 2;
+            if (((word >> shift) & 0xF) != 0xF) {
+                word += uint64_t{1} << shift;
+                added = true;
+            }
+        }
+        if (added && ++samples >= sampleLimit) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            halve();
+        }
+    }
+    
+    inline uint32_t Estimate(uint32_t hash) const noexcept {
+        uint32_t estimate = 0xF;
+        for (int i = 0; i < 4; ++i) {
+            size_t counter = counterOf(hash, i);
+            int shift = static_cast<int>(counter & 15) << 2;
+            estimate = std::min(estimate, static_cast<uint32_t>((table[counter >> 4] >> shift) & 0xF));
+        }
+        return estimate;
+    }
+    
+    // A candidate replaces the victim only if it is estimated to be strictly hotter
+    inline bool Admit(uint32_t candidateHash, uint32_t victimHash) const noexcept {
+        return Estimate(candidateHash) > Estimate(victimHash);
+    }
+    
+private:
+    inline size_t counterOf(uint32_t hash, int i) const noexcept {
+        uint64_t h = (static_cast<uint64_t>(hash) + SEEDS[i]) * SEEDS[i];
+        h ^= h >> 32;
+        return static_cast<size_t>(h) & counterMask;
+    }
+    
+    void halve() noexcept {
+        for (uint64_t& word : table) {
+            word = (word >> 1) & RESET_MASK;
+        }
+        samples /= 2;
+    }
+    
+    std::vector<uint64_t> table;
+    size_t counterMask = 0;
+    size_t sampleLimit = 0;
+    size_t samples = 0;
+};
+
+// Default eviction policy: the cache's own constant-time LFU bucket list, with LRU order
+// among entries of equal frequency (plus optional LFU-DA aging and TinyLFU admission).
+//
+// A replacement policy sets ENABLED = true and keeps its own order over the cache's node
+// pool slots (indices below the capacity), typically in per-slot arrays sized once by
+//     void Reset(size_t capacity);
+// so the pool and key index stay shared and nothing is allocated after construction.
+// The cache calls, all noexcept:
+//     void OnInsert(uint32_t slot, uint32_t hash);  // a new key now occupies slot
+//     void OnAccess(uint32_t slot);                 // hit or overwrite of a live entry
+//     uint32_t Victim(uint32_t hash);               // full cache: the slot to evict for hash
+//     void OnEvict(uint32_t slot, uint32_t hash);   // slot is about to be evicted (history)
+//     void Unlink(uint32_t slot);                   // slot leaves (evicted, expired, ...)
+//     template<typename Fn> void ForEach(Fn&& fn) const;  // fn(slot) for every live slot
+// Hashes are the cache's mixed 32-bit key hashes; policies with ghost history remember
+// evicted keys by hash alone.
+struct LFUEviction {
+    static constexpr bool ENABLED = false;
+};
+
+// Intrusive doubly linked lists over slot numbers for eviction policies. Every slot is
+// in at most one of the LISTS lists; each list runs from its newest entry (front) to its
+// oldest (back), and every slot carries a small counter for the policy's own use.
+template<size_t LISTS>
+class LFUSlotLists {
+public:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    static constexpr uint8_t NO_LIST = std::numeric_limits<uint8_t>::max();
+    
+    void Reset(size_t slots) {
+        links.assign(slots, Link{NONE, NONE, NO_LIST, 0});
+        lists.fill(List{NONE, NONE, 0});
+    }
+    
+    inline void PushFront(uint8_t list, uint32_t slot) noexcept {
+        List& target = lists[list];
+        links[slot] = Link{NONE, target.front, list, links[slot].counter};
+        if (target.front != NONE) {
+            links[target.front].prev = slot;
+        } else {
+            target.back = slot;
+        }
+        target.front = slot;
+        ++target.size;
+    }
+    
+    inline void Unlink(uint32_t slot) noexcept {
+        Link& link = links[slot];
+        List& source = lists[link.list];
+        if (link.prev != NONE) {
+            links[link.prev].next = link.next;
+        } else {
+            source.front = link.next;
+        }
+        if (link.next != NONE) {
+            links[link.next].prev = link.prev;
+        } else {
+            source.back = link.prev;
+        }
+        --source.size;
+        link.prev = link.next = NONE;
+        link.list = NO_LIST;
+    }
+    
+    // Moves a linked slot to the front of list (its own or another one)
+    inline void MoveToFront(uint8_t list, uint32_t slot) noexcept {
+        Unlink(slot);
+        PushFront(list, slot);
+    }
+    
+    // other takes the linked slot's place in its list; slot ends up unlinked
+    inline void Replace(uint32_t slot, uint32_t other) noexcept {
+        Link& link = links[slot];
+        List& list = lists[link.list];
+        links[other] = Link{link.prev, link.next, link.list, links[other].counter};
+        if (link.prev != NONE) {
+            links[link.prev].next = other;
+        } else {
+            list.front = other;
+        }
+        if (link.next != NONE) {
+            links[link.next].prev = other;
+        } else {
+            list.back = other;
+        }
+        link.prev = link.next = NONE;
+        link.list = NO_LIST;
+    }
+    
+    inline uint32_t Back(uint8_t list) const noexcept { return lists[list].back; }
+    inline size_t Size(uint8_t list) const noexcept { return lists[list].size; }
+    inline bool Linked(uint32_t slot) const noexcept { return links[slot].list != NO_LIST; }
+    inline uint8_t ListOf(uint32_t slot) const noexcept { return links[slot].list; }
+    inline uint8_t& Counter(uint32_t slot) noexcept { return links[slot].counter; }
+    inline uint8_t Counter(uint32_t slot) const noexcept { return links[slot].counter; }
+    
+    template<typename Fn>
+    void ForEach(uint8_t list, Fn&& fn) const {
+        for (uint32_t slot = lists[list].front; slot != NONE; slot = links[slot].next) {
+            fn(slot);
+        }
+    }
+    
+private:
+    struct Link {
+        uint32_t prev;
+        uint32_t next;
+        uint8_t list;
+        uint8_t counter;
+    };
+    struct List {
+        uint32_t front;
+        uint32_t back;
+        size_t size;
+    };
+    
+    std::vector<Link> links;
+    std::array<List, LISTS> lists;
+};
+
+// Bounded history of evicted keys (by hash) for ARC, S3-FIFO and LIRS: an LRU list of
+// ghost entries with an open-addressing hash index, so lookup, insert and removal are O(1)
+// and the memory is fixed at Reset(). A hash collision can only cause a spurious ghost hit.
+class LFUGhostList {
+public:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    
+    void Reset(size_t capacityValue) {
+        limit = std::max<size_t>(capacityValue, 1);
+        entries.assign(limit, Entry{0, NONE, NONE});
+        index.assign(std::bit_ceil(limit * 2), Slot{0, NONE});
+        indexMask = index.size() - 1;
+        front = back = freeHead = NONE;
+        used = 0;
+        size = 0;
+    }
+    
+    // OPTIMIZATION: Slots carry the hash, so a miss (the common case) touches one line
+    inline uint32_t Find(uint32_t hash) const noexcept {
+        for (size_t pos = hash & indexMask; index[pos].id != NONE; pos = (pos + 1) & indexMask) {
+            if (index[pos].hash == hash) {
+                return index[pos].id;
+            }
+        }
+        return NONE;
+    }
+    
+    inline bool Contains(uint32_t hash) const noexcept { return Find(hash) != NONE; }
+    
+    // Records hash as the newest ghost, dropping the oldest one when full; returns its id
+    inline uint32_t PushFront(uint32_t hash) noexcept {
+        uint32_t id = Find(hash);
+        if (id != NONE) {
+            unlinkEntry(id);
+        } else {
+            if (size == limit) {
+                Erase(back);
+            }
+            if (freeHead != NONE) {
+                id = freeHead;
+                freeHead = entries[id].next;
+            } else {
+                id = static_cast<uint32_t>(used++);
+            }
+            entries[id].hash = hash;
+            size_t pos = hash & indexMask;
+            while (index[pos].id != NONE) {
+                pos = (pos + 1) & indexMask;
+            }
+            index[pos] = Slot{hash, id};
+            ++size;
+        }
+        entries[id].prev = NONE;
+        entries[id].next = front;
+        if (front != NONE) {
+            entries[front].prev = id;
+        } else {
+            back = id;
+        }
+        front = id;
+        return id;
+    }
+    
+    inline void Erase(uint32_t id) noexcept {
+        unlinkEntry(id);
+        size_t pos = entries[id].hash & indexMask;
+        while (index[pos].id != id) {
+            pos = (pos + 1) & indexMask;
+        }
+        // Backward-shift deletion, as in LFUFlatIndex
+        size_t hole = pos;
+        for (size_t next = (pos + 1) & indexMask; index[next].id != NONE; next = (next + 1) & indexMask) {
+            size_t home = index[next].hash & indexMask;
+            if (((next - home) & indexMask) >= ((next - hole) & indexMask)) {
+                index[hole] = index[next];
+                hole = next;
+            }
+        }
+        index[hole] = Slot{0, NONE};
+        entries[id].next = freeHead;
+        freeHead = id;
+        --size;
+    }
+    
+    inline void PopBack() noexcept { Erase(back); }
+    inline uint32_t Back() const noexcept { return back; }
+    inline size_t Size() const noexcept { return size; }
+    inline bool Full() const noexcept { return size == limit; }
+    
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t prev;
+        uint32_t next;
+    };
+    struct Slot {
+        uint32_t hash;
+        uint32_t id;
+    };
+    
+    inline void unlinkEntry(uint32_t id) noexcept {
+        Entry& entry = entries[id];
+        if (entry.prev != NONE) {
+            entries[entry.prev].next = entry.next;
+        } else {
+            front = entry.next;
+        }
+        if (entry.next != NONE) {
+            entries[entry.next].prev = entry.prev;
+        } else {
+            back = entry.prev;
+        }
+    }
+    
+    std::vector<Entry> entries;
+    std::vector<Slot> index;
+    size_t indexMask = 0;
+    size_t limit = 0;
+    size_t used = 0;
+    size_t size = 0;
+    uint32_t front = NONE;
+    uint32_t back = NONE;
+    uint32_t freeHead = NONE;
+};
+
+// Least recently used: a hit moves the entry to the front, the back is evicted
+class LRUEviction {
+public:
+    static constexpr bool ENABLED = true;
+    
+    void Reset(size_t capacity) { order.Reset(capacity); }
+    
+    inline void OnInsert(uint32_t slot, uint32_t) noexcept { order.PushFront(0, slot); }
+    inline void OnAccess(uint32_t slot) noexcept { order.MoveToFront(0, slot); }
+    inline uint32_t Victim(uint32_t) noexcept { return order.Back(0); }
+    inline void OnEvict(uint32_t, uint32_t) noexcept {}
+    inline void Unlink(uint32_t slot) noexcept { order.Unlink(slot); }
+    
+    template<typename Fn>
+    void ForEach(Fn&& fn) const { order.ForEach(0, fn); }
+    
+private:
+    LFUSlotLists<1> order;
+};
+
+// Adaptive Replacement Cache (Megiddo and Modha, FAST '03). T1 holds entries seen once
+// recently, T2 entries seen at least twice; ghost lists B1/B2 remember keys evicted from
+// each. A miss that hits B1 grows T1's target share p, one that hits B2 shrinks it, so
+// the split between recency and frequency follows the workload. A scan only cycles
+// through T1.
+class ARCEviction {
+public:
+    static constexpr bool ENABLED = true;
+    
+    void Reset(size_t capacityValue) {
+        capacity = capacityValue;
+        lists.Reset(capacityValue);
+        recentGhosts.Reset(capacityValue);
+        frequentGhosts.Reset(capacityValue);
+        target = 0;
+        checkedHash = NO_HASH;
+    }
+    
+    // A key found in B1 or B2 enters T2. Victim() has already looked the key up (and
+    // consumed its ghost) when the cache was full.
+    inline void OnInsert(uint32_t slot, uint32_t hash) noexcept {
+        bool returning = checkedHash == hash ? checkedReturning : consumeGhost(hash) != NO_GHOST;
+        checkedHash = NO_HASH;
+        lists.PushFront(returning ? FREQUENT : RECENT, slot);
+    }
+    
+    inline void OnAccess(uint32_t slot) noexcept { lists.MoveToFront(FREQUENT, slot); }
+    
+    // REPLACE(x, p): T1's LRU entry while T1 exceeds its target share, else T2's
+    inline uint32_t Victim(uint32_t hash) noexcept {
+        int ghost = consumeGhost(hash);
+        checkedHash = hash;
+        checkedReturning = ghost != NO_GHOST;
+        size_t recent = lists.Size(RECENT);
+        if (recent > 0 && (recent > target || (ghost == FREQUENT && recent == target) || lists.Size(FREQUENT) == 0)) {
+            return lists.Back(RECENT);
+        }
+        return lists.Back(FREQUENT);
+    }
+    
+    // The victim's key joins its list's ghosts; |T1| + |B1| stays within c and the whole
+    // directory within 2c
+    inline void OnEvict(uint32_t slot, uint32_t hash) noexcept {
+        size_t recent = lists.Size(RECENT);
+        size_t frequent = lists.Size(FREQUENT);
+        if (lists.ListOf(slot) == RECENT) {
+            recentGhosts.PushFront(hash);
+            --recent;
+        } else {
+            frequentGhosts.PushFront(hash);
+            --frequent;
+        }
+        while (recentGhosts.Size() > 0 && recent + recentGhosts.Size() > capacity) {
+            recentGhosts.PopBack();
+        }
+        while (frequentGhosts.Size() > 0 &&
+               recent + frequent + recentGhosts.Size() + frequentGhosts.Size() > 2 * capacity) {
+            frequentGhosts.PopBack();
+        }
+    }
+    
+    inline void Unlink(uint32_t slot) noexcept { lists.Unlink(slot); }
+    
+    template<typename Fn>
+    void ForEach(Fn&& fn) const {
+        lists.ForEach(RECENT, fn);
+        lists.ForEach(FREQUENT, fn);
+    }
+    
+    // Current target size p of T1
+    inline size_t Target() const noexcept { return target; }
+    
+private:
+    static constexpr uint8_t RECENT = 0;
+    static constexpr uint8_t FREQUENT = 1;
+    static constexpr int NO_GHOST = -1;
+    static constexpr uint64_t NO_HASH = std::numeric_limits<uint64_t>::max();
+    
+    // Adapts p if hash is a ghost and removes that ghost; returns the list it was in
+    inline int consumeGhost(uint32_t hash) noexcept {
+        size_t recentSize = std::max<size_t>(recentGhosts.Size(), 1);
+        size_t frequentSize = std::max<size_t>(frequentGhosts.Size(), 1);
+        uint32_t ghost = recentGhosts.Find(hash);
+        if (ghost != LFUGhostList::NONE) {
+            target = std::min(capacity, target + std::max<size_t>(frequentSize / recentSize, 1));
+            recentGhosts.Erase(ghost);
+            return RECENT;
+        }
+        ghost = frequentGhosts.Find(hash);
+        if (ghost != LFUGhostList::NONE) {
+            size_t step = std::max<size_t>(recentSize / frequentSize, 1);
+            target = target > step ? target - step : 0;
+            frequentGhosts.Erase(ghost);
+            return FREQUENT;
+        }
+        return NO_GHOST;
+    }
+    
+    LFUSlotLists<2> lists;
+    LFUGhostList recentGhosts;
+    LFUGhostList frequentGhosts;
+    size_t capacity = 0;
+    size_t target = 0;
+    uint64_t checkedHash = NO_HASH;
+    bool checkedReturning = false;
+};
+
+// S3-FIFO (Yang et al., SOSP '23): new keys enter a small FIFO queue (SMALL_PERCENT of the
+// capacity); entries hit while there move on to the main FIFO with their counter reset,
+// the rest leave quickly and are remembered in a ghost queue so that a returning key goes
+// straight to main. Main is a FIFO with lazy promotion: a hit only bumps a 2-bit counter,
+// and entries reaching the back with a nonzero counter are reinserted with the counter
+// decremented. Hits never relink, so they cost one byte write.
+template<size_t SMALL_PERCENT = 10>
+class S3FIFOEviction {
+public:
+    static constexpr bool ENABLED = true;
+    static constexpr uint8_t MAX_COUNT = 3;
+    
+    static_assert(SMALL_PERCENT > 0 && SMALL_PERCENT < 100, "SMALL_PERCENT must be in (0, 100)");
+    
+    void Reset(size_t capacity) {
+        smallCapacity = std::max<size_t>(1, capacity * SMALL_PERCENT / 100);
+        queues.Reset(capacity);
+        ghosts.Reset(capacity);
+    }
+    
+    inline void OnInsert(uint32_t slot, uint32_t hash) noexcept {
+        queues.Counter(slot) = 0;
+        uint32_t ghost = ghosts.Find(hash);
+        if (ghost != LFUGhostList::NONE) {
+            ghosts.Erase(ghost);
+            queues.PushFront(MAIN, slot);
+        } else {
+            queues.PushFront(SMALL, slot);
+        }
+    }
+    
+    inline void OnAccess(uint32_t slot) noexcept {
+        uint8_t& counter = queues.Counter(slot);
+        counter = std::min<uint8_t>(counter + 1, MAX_COUNT);
+    }
+    
+    inline uint32_t Victim(uint32_t) noexcept {
+        for (;;) {
+            if (queues.Size(SMALL) >= smallCapacity || queues.Size(MAIN) == 0) {
+                uint32_t slot = queues.Back(SMALL);
+                if (queues.Counter(slot) == 0) {
+                    return slot;
+                }
+                queues.Counter(slot) = 0;
+                queues.MoveToFront(MAIN, slot);
+            } else {
+                uint32_t slot = queues.Back(MAIN);
+                uint8_t& counter = queues.Counter(slot);
+                if (counter == 0) {
+                    return slot;
+                }
+                --counter;
+                queues.MoveToFront(MAIN, slot);
+            }
+        }
+    }
+    
+    // Only keys leaving the small queue are remembered
+    inline void OnEvict(uint32_t slot, uint32_t hash) noexcept {
+        if (queues.ListOf(slot) == SMALL) {
+            ghosts.PushFront(hash);
+        }
+    }
+    
+    inline void Unlink(uint32_t slot) noexcept { queues.Unlink(slot); }
+    
+    template<typename Fn>
+    void ForEach(Fn&& fn) const {
+        queues.ForEach(SMALL, fn);
+        queues.ForEach(MAIN, fn);
+    }
+    
+private:
+    static constexpr uint8_t SMALL = 0;
+    static constexpr uint8_t MAIN = 1;
+    
+    LFUSlotLists<2> queues;
+    LFUGhostList ghosts;
+    size_t smallCapacity = 1;
+};
+
+// LIRS (Jiang and Zhang, SIGMETRICS '02): ranks entries by inter-reference recency (IRR),
+// the number of distinct keys seen between their last two accesses. Low-IRR (LIR) entries
+// hold all but HIR_PERCENT of the capacity and are never evicted directly; the others
+// are resident HIR entries in a FIFO queue Q that supplies the victims. The recency stack
+// S holds the LIR entries plus recently seen HIR entries, resident or evicted (ghosts).
+// An HIR key accessed again while still in S has a lower IRR than the oldest LIR entry
+// and trades places with it. S is pruned so that its oldest entry is always LIR.
+template<size_t HIR_PERCENT = 1>
+class LIRSEviction {
+public:
+    static constexpr bool ENABLED = true;
+    
+    static_assert(HIR_PERCENT > 0 && HIR_PERCENT < 100, "HIR_PERCENT must be in (0, 100)");
+    
+    // S links slots [0, capacity) and ghosts, the ghost with id g as capacity + g
+    void Reset(size_t capacityValue) {
+        capacity = capacityValue;
+        lirLimit = std::max<size_t>(1, capacityValue - std::max<size_t>(1, capacityValue * HIR_PERCENT / 100));
+        stack.Reset(capacityValue * 2);
+        queue.Reset(capacityValue);
+        ghosts.Reset(capacityValue);
+        lirCount = 0;
+    }
+    
+    inline void OnInsert(uint32_t slot, uint32_t hash) noexcept {
+        uint32_t ghost = ghosts.Find(hash);
+        if (ghost != LFUGhostList::NONE) {
+            // Evicted HIR key still in S: it returns as LIR
+            stack.Unlink(ghostId(ghost));
+            ghosts.Erase(ghost);
+            stack.PushFront(0, slot);
+            promote(slot);
+        } else if (lirCount < lirLimit) {
+            // Until the LIR set is full, new keys join it directly
+            stack.PushFront(0, slot);
+            stack.Counter(slot) = LIR;
+            ++lirCount;
+            prune();
+        } else {
+            stack.PushFront(0, slot);
+            stack.Counter(slot) = HIR;
+            queue.PushFront(0, slot);
+        }
+    }
+    
+    inline void OnAccess(uint32_t slot) noexcept {
+        if (stack.Counter(slot) == LIR) {
+            bool oldest = stack.Back(0) == slot;
+            stack.MoveToFront(0, slot);
+            if (oldest) {
+                prune();
+            }
+        } else if (stack.Linked(slot)) {
+            stack.MoveToFront(0, slot);
+            queue.Unlink(slot);
+            promote(slot);
+        } else {
+            stack.PushFront(0, slot);
+            queue.MoveToFront(0, slot);
+        }
+    }
+    
+    // The oldest resident HIR entry, or the oldest LIR entry if entries were removed and
+    // every remaining one is LIR
+    inline uint32_t Victim(uint32_t) noexcept {
+        uint32_t slot = queue.Back(0);
+        return slot != LFUSlotLists<1>::NONE ? slot : stack.Back(0);
+    }
+    
+    // An evicted HIR entry that is still in S stays there as a ghost
+    inline void OnEvict(uint32_t slot, uint32_t hash) noexcept {
+        if (stack.Counter(slot) == HIR && stack.Linked(slot)) {
+            if (ghosts.Full()) {
+                uint32_t oldest = ghosts.Back();
+                stack.Unlink(ghostId(oldest));
+                ghosts.Erase(oldest);
+            }
+            stack.Replace(slot, ghostId(ghosts.PushFront(hash)));
+        }
+    }
+    
+    inline void Unlink(uint32_t slot) noexcept {
+        if (queue.Linked(slot)) {
+            queue.Unlink(slot);
+        }
+        if (stack.Linked(slot)) {
+            stack.Unlink(slot);
+        }
+        if (stack.Counter(slot) == LIR) {
+            stack.Counter(slot) = HIR;
+            --lirCount;
+            prune();
+        }
+    }
+    
+    // LIR entries (all in S), then resident HIR entries (all in Q)
+    template<typename Fn>
+    void ForEach(Fn&& fn) const {
+        stack.ForEach(0, [&](uint32_t id) {
+            if (id < capacity && stack.Counter(id) == LIR) {
+                fn(id);
+            }
+        });
+        queue.ForEach(0, fn);
+    }
+    
+private:
+    static constexpr uint8_t HIR = 0;
+    static constexpr uint8_t LIR = 1;
+    
+    inline uint32_t ghostId(uint32_t ghost) const noexcept { return static_cast<uint32_t>(capacity) + ghost; }
+    
+    // slot, already at the top of S, becomes LIR; if the LIR set is full its oldest entry
+    // becomes the newest resident HIR entry
+    inline void promote(uint32_t slot) noexcept {
+        stack.Counter(slot) = LIR;
+        if (lirCount < lirLimit) {
+            ++lirCount;
+        } else {
+            uint32_t oldest = stack.Back(0);
+            stack.Unlink(oldest);
+            stack.Counter(oldest) = HIR;
+            queue.PushFront(0, oldest);
+        }
+        prune();
+    }
+    
+    // Pops HIR entries and ghosts off the bottom of S until a LIR entry is there
+    inline void prune() noexcept {
+        for (uint32_t id = stack.Back(0); id != LFUSlotLists<1>::NONE; id = stack.Back(0)) {
+            if (id < capacity && stack.Counter(id) == LIR) {
+                return;
+            }
+            stack.Unlink(id);
+            if (id >= capacity) {
+                ghosts.Erase(id - static_cast<uint32_t>(capacity));
+            }
+        }
+    }
+    
+    LFUSlotLists<1> stack;
+    LFUSlotLists<1> queue;
+    LFUGhostList ghosts;
+    size_t capacity = 0;
+    size_t lirLimit = 1;
+    size_t lirCount = 0;
+};
+
+template<typename Key, typename Value, size_t MAX_SIZE, typename Hash = std::hash<Key>,
+         typename Admission = LFUAlwaysAdmit, typename KeyEqual = std::equal_to<Key>,
+         typename EvictionListener = LFUNoEvictionListener, typename Weigher = LFUUnitWeigher,
+         typename Expiry = LFUNoExpiry, typename Stats = LFUNoStats, typename Eviction = LFUEviction>
 class LFUCache {
 public:
-    // OPTIMIZATION: Constant folding - compile-time constants
-    static constexpr size_t MIN_FREQUENCY_SIZE = 16;
-    static constexpr size_t INITIAL_SIZE_MULTIPLIER = 10;
-    static constexpr size_t GROWTH_FACTOR = 2;
+    // MAX_SIZE == LFU_DYNAMIC_CAPACITY selects a capacity given at construction, with all
+    // pools carved out of one heap allocation instead of being embedded in the object
+    static constexpr bool IS_DYNAMIC = MAX_SIZE == LFU_DYNAMIC_CAPACITY;
+    
+    // OPTIMIZATION: Compact links - all nodes and buckets live in fixed pools, so links are
+    // pool indices: 16-bit when MAX_SIZE allows, 32-bit otherwise (selected at compile time)
+    using IndexType = std::conditional_t<(MAX_SIZE < UINT16_MAX - 1), uint16_t, uint32_t>;
+    static constexpr IndexType NIL = std::numeric_limits<IndexType>::max();
+    
+    // Frequencies saturate instead of overflowing; dynamic aging rebases well before that
+    static constexpr int MAX_FREQUENCY = std::numeric_limits<int>::max();
+    static constexpr int AGE_REBASE_THRESHOLD = 1 << 30;
+    
+    // OPTIMIZATION: Keys resolved per prefetch round; enough to cover DRAM latency
+    // without the early prefetches being evicted before they are used
+    static constexpr size_t PREFETCH_BATCH = 16;
+    
+    // OPTIMIZATION: Nodes cache the mixed hash of their key unless the key is a scalar, so
+    // evictions and admission decisions never rehash (long string keys) while int keys
+    // keep their compact nodes. Selected at compile time like IndexType.
+    static constexpr bool STORES_HASH = !std::is_scalar_v<Key>;
+    struct NoStoredHash {};
+    using StoredHash = std::conditional_t<STORES_HASH, uint32_t, NoStoredHash>;
+    
+    // Weighted caches remember each entry's weight so evictions never call the weigher
+    struct NoStoredWeight {};
+    using StoredWeight = std::conditional_t<Weigher::ENABLED, size_t, NoStoredWeight>;
+    
+    static_assert(!(Weigher::ENABLED && Admission::ENABLED),
+                  "A weighted capacity cannot be combined with an admission policy");
+    static_assert(!(Eviction::ENABLED && Admission::ENABLED),
+                  "An eviction policy cannot be combined with an admission policy");
+    static_assert(!(Eviction::ENABLED && Weigher::ENABLED),
+                  "An eviction policy cannot be combined with a weighted capacity");
+    
+    // Hierarchical timer wheel (expiring caches only): WHEEL_LEVELS levels of WHEEL_SLOTS
+    // slots, each level's slot spanning WHEEL_SLOTS times the ticks of the one below, so
+    // deadlines up to 2^24 ticks ahead are placed directly and later ones are re-placed
+    // when their top-level slot comes round. Scheduling and cancelling are O(1).
+    static constexpr unsigned WHEEL_SLOT_BITS = 6;
+    static constexpr size_t WHEEL_SLOTS = size_t{1} << WHEEL_SLOT_BITS;
+    static constexpr size_t WHEEL_LEVELS = 4;
+    static constexpr uint16_t NO_TIMER = std::numeric_limits<uint16_t>::max();
+    
+    // Timer list links live in the node itself, like the frequency list links
+    struct TimerLinks {
+        uint64_t deadline = 0;      // Expiry tick, valid while slot != NO_TIMER
+        IndexType prev = NIL;
+        IndexType next = NIL;
+        uint16_t slot = NO_TIMER;   // level * WHEEL_SLOTS + slot, or NO_TIMER if not scheduled
+    };
+    struct NoTimerLinks {};
+    using StoredTimer = std::conditional_t<Expiry::ENABLED, TimerLinks, NoTimerLinks>;
+    
+    struct Node {
+        // Hot fields first (accessed most frequently)
+        IndexType bucket;       // Frequency bucket this node currently lives in
+        IndexType prev;         // Link fields together
+        IndexType next;
+        [[no_unique_address]] StoredHash hash;  // Mixed key hash (non-scalar keys only)
+        [[no_unique_address]] StoredWeight weight{};  // Weigher result (weighted caches only)
+        [[no_unique_address]] StoredTimer timer{};    // Expiry deadline and wheel links
+        Key key;
+        Value value;
+        
+        // No default constructor: nodes are constructed in place only when a slot is used,
+        // with the key forwarded and the value built directly from the caller's arguments
+        template<typename K, typename... Args>
+        Node(std::in_place_t, uint32_t h, K&& k, Args&&... args)
+            : bucket(NIL), prev(NIL), next(NIL), hash(storedHash(h)), key(std::forward<K>(k)),
+              value(std::forward<Args>(args)...) {}
+        
+    private:
+        static constexpr StoredHash storedHash(uint32_t h) noexcept {
+            if constexpr (STORES_HASH) {
+                return h;
+            } else {
+                (void)h;
+                return StoredHash{};
+            }
+        }
+    };
+    
+    // One bucket per distinct frequency. Buckets form a list sorted by ascending
+    // frequency, so the bucket for f+1 is always the neighbour of the bucket for f
+    // and the head bucket holds the least frequently used entries. Trivial type, so the
+    // bucket pool is left uninitialized until allocateBucket() fills a slot.
+    struct FrequencyList {
+        int frequency;
+        IndexType head;         // Most recently used node of this frequency
+        IndexType tail;         // Least recently used node of this frequency
+        IndexType prev;         // Bucket with the next lower frequency
+        IndexType next;         // Bucket with the next higher frequency
+        
+        // OPTIMIZATION: Force inlining of simple getters
+        inline bool Empty() const { return head == NIL; }
+        inline bool Single() const { return head == tail; }
+    };
+    
+    template<typename T, size_t N>
+    using PoolArray = std::conditional_t<IS_DYNAMIC, T*, std::array<T, N>>;
+    
+    // Fixed-size memory pool for maximum performance; nodes are constructed lazily
+    std::conditional_t<IS_DYNAMIC, Node*, LFURawArray<Node, MAX_SIZE>> nodePool;
+    PoolArray<IndexType, MAX_SIZE> freeNodes;
+    size_t poolSize;
+    size_t freeCount;
+    
+    // Flat key index storing pool indices; replaces a node-based hash map
+    LFUFlatIndex<MAX_SIZE> keyIndex;
+    size_t count;
+    Hash hasher;
+    KeyEqual keyEqual;
+    
+    // Frequency buckets: distinct frequencies never exceed the number of entries,
+    // plus one bucket created by a hit before the old one is released (none are used
+    // with an Eviction policy, which keeps its own order)
+    static constexpr size_t BUCKET_SLOTS = Eviction::ENABLED ? 1 : MAX_SIZE + 1;
+    PoolArray<FrequencyList, BUCKET_SLOTS> bucketPool;
+    PoolArray<IndexType, BUCKET_SLOTS> freeBuckets;
+    size_t bucketPoolSize;
+    size_t freeBucketCount;
+    IndexType minBucket;    // Head of the bucket list (lowest frequency)
+    
+    // Admission policy state; with TinyLFUAdmission the LRU window is a bucket kept
+    // outside the frequency list (its nodes have bucket == windowBucket)
+    [[no_unique_address]] Admission admission;
+    IndexType windowBucket;
+    size_t windowCount;
+    
+    // Replacement policy state (LRU, ARC, S3-FIFO, LIRS); empty with the built-in LFU
+    [[no_unique_address]] Eviction eviction;
+    
+    // Receives evicted entries; empty and never called with LFUNoEvictionListener
+    [[no_unique_address]] EvictionListener listener;
+    
+    // Weighted capacity: the sum of entry weights is kept within maxWeight by evicting
+    // from the LFU end, on top of the entry-count limit (unlimited by default)
+    [[no_unique_address]] Weigher weigher;
+    size_t totalWeight = 0;
+    size_t maxWeight = std::numeric_limits<size_t>::max();
+    
+    // Timer wheel slot heads with one occupancy bitmap per level, so advancing the wheel
+    // jumps straight to the next occupied slot instead of stepping tick by tick
+    struct TimerWheel {
+        std::array<IndexType, WHEEL_LEVELS * WHEEL_SLOTS> heads;
+        std::array<uint64_t, WHEEL_LEVELS> occupied;
+        uint64_t time;          // Every deadline at or before this tick has been processed
+        uint64_t defaultTtl;    // In ticks, 0 = entries without an explicit TTL never expire
+    };
+    struct NoTimerWheel {};
+    [[no_unique_address]] std::conditional_t<Expiry::ENABLED, TimerWheel, NoTimerWheel> wheel;
+    
+    // Hit/miss/eviction counters; empty and never touched with LFUNoStats
+    [[no_unique_address]] Stats stats;
+    
+    // Frequency aging (LFU-DA); cacheAge stays 0 while dynamic aging is off
+    bool dynamicAging;
+    int cacheAge;
+    
+    // Runtime capacity and the single allocation holding every pool (dynamic caches only)
+    struct NoRegion {
+        inline std::byte* Data() const noexcept { return nullptr; }
+        inline bool HugePages() const noexcept { return false; }
+    };
+    size_t dynamicCapacity;
+    [[no_unique_address]] std::conditional_t<IS_DYNAMIC, LFUHeapRegion, NoRegion> region;
+    
+private:
+    // OPTIMIZATION: Constant folding - capacity is a compile-time constant for fixed caches
+    inline size_t capacity() const noexcept {
+        if constexpr (IS_DYNAMIC) {
+            return dynamicCapacity;
+        } else {
+            return MAX_SIZE;
+        }
+    }
+    
+    // Carves the node pool, bucket pool, key index and free lists out of one region
+    void allocateRegion(size_t capacityValue, bool useHugePages) {
+        using Slot = typename LFUFlatIndex<MAX_SIZE>::Slot;
+        auto align = [](size_t offset) {
+            return (offset + LFUHeapRegion::ALIGNMENT - 1) & ~(LFUHeapRegion::ALIGNMENT - 1);
+        };
+        
+        size_t slotCount = LFUFlatIndex<MAX_SIZE>::SlotsFor(capacityValue);
+        size_t bucketCount = Eviction::ENABLED ? 1 : capacityValue + 1;
+        size_t nodesOffset = 0;
+        size_t bucketsOffset = align(nodesOffset + capacityValue * sizeof(Node));
+        size_t slotsOffset = align(bucketsOffset + bucketCount * sizeof(FrequencyList));
+        size_t freeNodesOffset = align(slotsOffset + slotCount * sizeof(Slot));
+        size_t freeBucketsOffset = align(freeNodesOffset + capacityValue * sizeof(IndexType));
+        size_t totalBytes = align(freeBucketsOffset + bucketCount * sizeof(IndexType));
+        
+        region = LFUHeapRegion(totalBytes, useHugePages);
+        std::byte* base = region.Data();
+        nodePool = reinterpret_cast<Node*>(base + nodesOffset);
+        bucketPool = reinterpret_cast<FrequencyList*>(base + bucketsOffset);
+        freeNodes = reinterpret_cast<IndexType*>(base + freeNodesOffset);
+        freeBuckets = reinterpret_cast<IndexType*>(base + freeBucketsOffset);
+        keyIndex.Attach(reinterpret_cast<Slot*>(base + slotsOffset), slotCount);
+    }
+    
+    // Visits the pool index of every live node: the admission window, then each bucket
+    // (or the eviction policy's own lists)
+    template<typename Fn>
+    void forEachNode(Fn&& fn) const {
+        if constexpr (Eviction::ENABLED) {
+            eviction.ForEach([&](uint32_t slot) { fn(static_cast<IndexType>(slot)); });
+            return;
+        }
+        auto visitList = [&](IndexType current) {
+            while (current != NIL) {
+                IndexType next = nodePool[current].next;
+                fn(current);
+                current = next;
+            }
+        };
+        if constexpr (Admission::ENABLED) {
+            visitList(bucketPool[windowBucket].head);
+        }
+        for (IndexType b = minBucket; b != NIL; b = bucketPool[b].next) {
+            visitList(bucketPool[b].head);
+        }
+    }
+    
+    // Destroys every live node; free slots hold no object
+    void destroyNodes() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<Node>) {
+            forEachNode([this](IndexType i) { std::destroy_at(&nodePool[i]); });
+        }
+    }
+    
+    // Copies the pool bookkeeping verbatim and copy-constructs only the live nodes,
+    // so every node keeps its pool index, links and frequency
+    void copyFrom(const LFUCache& other) requires (!IS_DYNAMIC) {
+        poolSize = other.poolSize;
+        freeCount = other.freeCount;
+        std::copy_n(other.freeNodes.begin(), freeCount, freeNodes.begin());
+        keyIndex = other.keyIndex;
+        count = other.count;
+        hasher = other.hasher;
+        keyEqual = other.keyEqual;
+        bucketPoolSize = other.bucketPoolSize;
+        std::copy_n(other.bucketPool.begin(), bucketPoolSize, bucketPool.begin());
+        std::copy_n(other.freeBuckets.begin(), other.freeBucketCount, freeBuckets.begin());
+        freeBucketCount = other.freeBucketCount;
+        minBucket = other.minBucket;
+        admission = other.admission;
+        listener = other.listener;
+        weigher = other.weigher;
+        totalWeight = other.totalWeight;
+        maxWeight = other.maxWeight;
+        wheel = other.wheel;
+        stats = other.stats;
+        windowBucket = other.windowBucket;
+        windowCount = other.windowCount;
+        eviction = other.eviction;
+        dynamicAging = other.dynamicAging;
+        cacheAge = other.cacheAge;
+        other.forEachNode([&](IndexType i) { std::construct_at(&nodePool[i], other.nodePool[i]); });
+    }
+    
+    // K is Key, or any type accepted by a transparent Hash and KeyEqual
+    template<typename K>
+    inline uint32_t hashOf(const K& key) const noexcept {
+        return LFUFlatIndex<MAX_SIZE>::Mix(hasher(key));
+    }
+    
+    // Mixed hash from a caller-computed Hash{}(key), for the *WithHash entry points
+    inline uint32_t mixHash(const Key& key, size_t hash) const noexcept {
+        assert(hash == hasher(key) && "hash must equal Hash{}(key)");
+        (void)key;
+        return LFUFlatIndex<MAX_SIZE>::Mix(hash);
+    }
+    
+    // Hash of a live node's key: cached for non-scalar keys, recomputed for scalars
+    inline uint32_t nodeHash(IndexType idx) const noexcept {
+        if constexpr (STORES_HASH) {
+            return nodePool[idx].hash;
+        } else {
+            return hashOf(nodePool[idx].key);
+        }
+    }
+    
+    template<typename K>
+    inline IndexType findIndex(const K& key, uint32_t hash) const noexcept {
+        uint32_t idx = keyIndex.Find(hash, [&](uint32_t i) { return keyEqual(nodePool[i].key, key); });
+        return idx == LFUFlatIndex<MAX_SIZE>::NOT_FOUND ? NIL : static_cast<IndexType>(idx);
+    }
+
+    // OPTIMIZATION: Force inlining of allocation functions (hot path)
+    template<typename K, typename... Args>
+    inline IndexType allocateNode(uint32_t hash, K&& key, Args&&... args) {
+        if (freeCount > 0) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            // Reuse freed slot
+            --freeCount;
+            IndexType idx = freeNodes[freeCount];
+            std::construct_at(&nodePool[idx], std::in_place, hash, std::forward<K>(key), std::forward<Args>(args)...);
+            return idx;
+        }
+        
+        // OPTIMIZATION: Template specialization opportunity for compile-time bounds check
+        if (poolSize >= capacity()) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            throw std::runtime_error("Node pool exhausted - increase MAX_SIZE template parameter");
+        }
+        
+        // Use next never-touched slot: constructing it here is what commits its memory
+        IndexType idx = static_cast<IndexType>(poolSize);
+        std::construct_at(&nodePool[idx], std::in_place, hash, std::forward<K>(key), std::forward<Args>(args)...);
+        poolSize++;
+        return idx;
+    }
+    
+    // OPTIMIZATION: Force inlining of deallocation (hot path)
+    inline void deallocateNode(IndexType idx) {
+        // OPTIMIZATION: Template-based bounds checking for better optimization
+        assert(idx < capacity() && "Invalid node index");
+        std::destroy_at(&nodePool[idx]);
+        
+        // Add to free list
+        freeNodes[freeCount] = idx;
+        ++freeCount;
+    }
+    
+    // OPTIMIZATION: Force inlining of critical path list operations
+    inline void linkToHead(IndexType bucketIdx, IndexType idx) noexcept {
+        FrequencyList& bucket = bucketPool[bucketIdx];
+        Node& node = nodePool[idx];
+        node.bucket = bucketIdx;
+        node.prev = NIL;
+        node.next = bucket.head;
+        if (bucket.head != NIL) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            nodePool[bucket.head].prev = idx;
+        } else {
+            bucket.tail = idx;
+        }
+        bucket.head = idx;
+    }
+    
+    // Appends at the LRU end; used to rebuild buckets in MRU-to-LRU order from a snapshot
+    inline void linkToTail(IndexType bucketIdx, IndexType idx) noexcept {
+        FrequencyList& bucket = bucketPool[bucketIdx];
+        Node& node = nodePool[idx];
+        node.bucket = bucketIdx;
+        node.next = NIL;
+        node.prev = bucket.tail;
+        if (bucket.tail != NIL) {
+            nodePool[bucket.tail].next = idx;
+        } else {
+            bucket.head = idx;
+        }
+        bucket.tail = idx;
+    }
+    
+    inline void unlink(IndexType idx) noexcept {
+        Node& node = nodePool[idx];
+        FrequencyList& bucket = bucketPool[node.bucket];
+        if (node.prev != NIL) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            nodePool[node.prev].next = node.next;
+        } else {
+            bucket.head = node.next;
+        }
+        if (node.next != NIL) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            nodePool[node.next].prev = node.prev;
+        } else {
+            bucket.tail = node.prev;
+        }
+        node.prev = node.next = NIL;
+    }
+    
+    // Creates an empty bucket and links it right after `after` (or at the front when NIL)
+    inline IndexType allocateBucket(int frequency, IndexType after) noexcept {
+        IndexType idx = freeBucketCount > 0 ? freeBuckets[--freeBucketCount]
+                                            : static_cast<IndexType>(bucketPoolSize++);
+        assert(idx < capacity() + 1 && "Bucket pool exhausted");
+        
+        FrequencyList& bucket = bucketPool[idx];
+        bucket = FrequencyList{frequency, NIL, NIL, after, after != NIL ? bucketPool[after].next : minBucket};
+        if (bucket.next != NIL) {
+            bucketPool[bucket.next].prev = idx;
+        }
+        if (after != NIL) {
+            bucketPool[after].next = idx;
+        } else {
+            minBucket = idx;
+        }
+        return idx;
+    }
+    
+    // Unlinks an empty bucket and returns it to the bucket pool
+    inline void releaseBucket(IndexType idx) noexcept {
+        FrequencyList& bucket = bucketPool[idx];
+        if (bucket.prev != NIL) {
+            bucketPool[bucket.prev].next = bucket.next;
+        } else {
+            minBucket = bucket.next;
+        }
+        if (bucket.next != NIL) {
+            bucketPool[bucket.next].prev = bucket.prev;
+        }
+        freeBuckets[freeBucketCount++] = idx;
+    }
+    
+    // OPTIMIZATION: Force inlining of frequency update (most critical function)
+    // Pure index relinking: no hashing and no allocation on a hit
+    inline void updateFrequency(IndexType idx) noexcept {
+        IndexType bucketIdx = nodePool[idx].bucket;
+        FrequencyList& bucket = bucketPool[bucketIdx];
+        if (bucket.frequency == MAX_FREQUENCY) [[unlikely]] {
+            // Saturated: only refresh recency within the top bucket
+            unlink(idx);
+            linkToHead(bucketIdx, idx);
+            return;
+        }
+        int newFreq = bucket.frequency + 1;
+        IndexType next = bucket.next;
+        
+        if (next != NIL && bucketPool[next].frequency == newFreq) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            unlink(idx);
+            linkToHead(next, idx);
+            if (bucket.Empty()) {
+                releaseBucket(bucketIdx);
+            }
+        } else if (bucket.Single()) {
+            // Sole member and no f+1 bucket: bump the bucket in place
+            bucket.frequency = newFreq;
+        } else {
+            unlink(idx);
+            linkToHead(allocateBucket(newFreq, bucketIdx), idx);
+        }
+    }
+    
+    // Links a new node at the insertion frequency: 1, or cacheAge + 1 under dynamic aging.
+    // Every live bucket is at least cacheAge, so the target is the head or its successor.
+    inline void linkToFirstBucket(IndexType idx) noexcept {
+        int frequency = cacheAge + 1;
+        IndexType first = minBucket;
+        if (first == NIL || bucketPool[first].frequency > frequency) [[unlikely]] {
+            first = allocateBucket(frequency, NIL);
+        } else if (bucketPool[first].frequency != frequency) [[unlikely]] {
+            assert(bucketPool[first].frequency == cacheAge && "Bucket below the cache age");
+            IndexType next = bucketPool[first].next;
+            first = next != NIL && bucketPool[next].frequency == frequency ? next : allocateBucket(frequency, first);
+        }
+        linkToHead(first, idx);
+    }
+    
+    // LFU-DA: the cache age becomes the frequency of the evicted LFU victim, so entries
+    // inserted from now on start level with it and stale counts stop pinning the cache
+    inline void ageTo(int victimFrequency) noexcept {
+        if (!dynamicAging) [[likely]] {
+            return;
+        }
+        cacheAge = victimFrequency;
+        if (cacheAge >= AGE_REBASE_THRESHOLD) [[unlikely]] {
+            rebaseFrequencies();
+        }
+    }
+    
+    // Shifts every bucket down so the cache age restarts at 1. Uniform shifting keeps the
+    // bucket order; it costs one pass over the buckets (not nodes) per ~2^30 age steps.
+    void rebaseFrequencies() noexcept {
+        int shift = cacheAge - 1;
+        for (IndexType b = minBucket; b != NIL; b = bucketPool[b].next) {
+            bucketPool[b].frequency -= shift;
+        }
+        cacheAge = 1;
+    }
+    
+    // Removes a linked node to make room
+    inline void evict(IndexType idx, uint32_t hash) noexcept {
+        if constexpr (Eviction::ENABLED) {
+            if constexpr (Stats::ENABLED) {
+                stats.RecordEviction(0);
+            }
+            eviction.OnEvict(idx, hash);
+        } else if constexpr (Stats::ENABLED) {
+            stats.RecordEviction(bucketPool[nodePool[idx].bucket].frequency);
+        }
+        remove(idx, hash);
+    }
+    
+    // Removes a linked node whose TTL has passed
+    inline void expire(IndexType idx, uint32_t hash) noexcept {
+        if constexpr (Stats::ENABLED) {
+            stats.RecordExpiration();
+        }
+        remove(idx, hash);
+    }
+    
+    // Removes a linked node from the cache entirely
+    inline void remove(IndexType idx, uint32_t hash) noexcept {
+        if constexpr (Eviction::ENABLED) {
+            eviction.Unlink(idx);
+            keyIndex.Erase(hash, idx);
+            releaseEvicted(idx);
+            --count;
+            return;
+        }
+        IndexType bucketIdx = nodePool[idx].bucket;
+        unlink(idx);
+        keyIndex.Erase(hash, idx);
+        releaseEvicted(idx);
+        --count;
+        if constexpr (Admission::ENABLED) {
+            if (bucketIdx == windowBucket) {
+                --windowCount;
+                return;
+            }
+        }
+        if (bucketPool[bucketIdx].Empty()) [[unlikely]] {
+            releaseBucket(bucketIdx);
+        }
+    }
+    
+    // Frees an unlinked, unindexed node, first handing its key and value to the listener
+    inline void releaseEvicted(IndexType idx) noexcept {
+        if constexpr (Weigher::ENABLED) {
+            totalWeight -= nodePool[idx].weight;
+        }
+        if constexpr (Expiry::ENABLED) {
+            timerUnlink(idx);
+        }
+        if constexpr (EvictionListener::ENABLED) {
+            Node& node = nodePool[idx];
+            listener.OnEvict(std::move(node.key), std::move(node.value));
+        }
+        deallocateNode(idx);
+    }
+    
+    // Re-weighs a node after it was inserted or its value replaced, then evicts from the
+    // LFU end until the budget holds. `keep` itself is never evicted here, so an entry
+    // heavier than the whole budget stays alone in the cache until the next insert.
+    inline void chargeWeight(IndexType keep) noexcept {
+        Node& node = nodePool[keep];
+        size_t weight = weigher(node.key, node.value);
+        totalWeight = totalWeight - node.weight + weight;
+        node.weight = weight;
+        shrinkToBudget(keep);
+    }
+    
+    inline void shrinkToBudget(IndexType keep) noexcept {
+        while (totalWeight > maxWeight) {
+            IndexType victim = bucketPool[minBucket].tail;
+            if (victim == keep) {
+                // Next least recently used entry of the same bucket, else the next bucket's LRU
+                victim = nodePool[keep].prev;
+                if (victim == NIL) {
+                    IndexType nextBucket = bucketPool[minBucket].next;
+                    victim = nextBucket != NIL ? bucketPool[nextBucket].tail : NIL;
+                }
+                if (victim == NIL) {
+                    return;
+                }
+            }
+            // Age to the LFU bucket even when the victim comes from the next one: `keep`
+            // stays there, and the age must not pass a live bucket
+            ageTo(bucketPool[minBucket].frequency);
+            evict(victim, nodeHash(victim));
+        }
+    }
+    
+    // Shared hit path: a window hit refreshes LRU order, a main hit bumps the frequency
+    inline void touch(IndexType idx) noexcept {
+        if constexpr (Eviction::ENABLED) {
+            eviction.OnAccess(idx);
+            return;
+        }
+        if constexpr (Admission::ENABLED) {
+            if (nodePool[idx].bucket == windowBucket) {
+                unlink(idx);
+                linkToHead(windowBucket, idx);
+                return;
+            }
+        }
+        updateFrequency(idx);
+    }
+    
+    // Read-only lookup for Contains(): an expired entry is reported absent but not removed
+    template<typename K>
+    inline IndexType liveIndex(const K& key) const noexcept {
+        IndexType idx = findIndex(key, hashOf(key));
+        if constexpr (Expiry::ENABLED) {
+            if (idx != NIL && expired(idx, Expiry::Now())) {
+                return NIL;
+            }
+        }
+        return idx;
+    }
+    
+    // Index lookup for reads and writes. Lazy expiry: a stale hit is removed and reported
+    // as a miss, so a write to it inserts a fresh entry instead of reviving the old one.
+    template<typename K>
+    inline IndexType findLiveIndex(const K& key, uint32_t hash) noexcept {
+        IndexType idx = findIndex(key, hash);
+        if constexpr (Expiry::ENABLED) {
+            if (idx != NIL && expired(idx, Expiry::Now())) {
+                expire(idx, hash);
+                idx = NIL;
+            }
+        }
+        return idx;
+    }
+    
+    template<typename K>
+    inline IndexType lookup(const K& key, uint32_t hash) noexcept {
+        [[maybe_unused]] uint64_t start = startTimer();
+        if constexpr (Admission::ENABLED) {
+            admission.Record(hash);
+        }
+        IndexType idx = findLiveIndex(key, hash);
+        if (idx != NIL) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            touch(idx);
+        }
+        if constexpr (Stats::ENABLED) {
+            idx != NIL ? stats.RecordHit() : stats.RecordMiss();
+        }
+        recordLatency(idx != NIL ? LFUOperation::GetHit : LFUOperation::GetMiss, start);
+        return idx;
+    }
+    
+    // Latency sampling hooks (timed Stats policies only; compiled out otherwise)
+    inline uint64_t startTimer() noexcept {
+        if constexpr (Stats::TIMED) {
+            return stats.StartTimer();
+        } else {
+            return 0;
+        }
+    }
+    
+    inline void recordLatency(LFUOperation operation, uint64_t start) noexcept {
+        if constexpr (Stats::TIMED) {
+            stats.RecordLatency(operation, start);
+        } else {
+            (void)operation;
+            (void)start;
+        }
+    }
+    
+    // Insert class for latency: an insert into a full cache has to evict first
+    inline LFUOperation insertOperation() const noexcept {
+        return count >= capacity() ? LFUOperation::PutEvict : LFUOperation::PutInsert;
+    }
+    
+    inline bool expired(IndexType idx, uint64_t now) const noexcept requires Expiry::ENABLED {
+        const TimerLinks& timer = nodePool[idx].timer;
+        return timer.slot != NO_TIMER && timer.deadline <= now;
+    }
+    
+    void resetWheel() noexcept {
+        if constexpr (Expiry::ENABLED) {
+            wheel.heads.fill(NIL);
+            wheel.occupied.fill(0);
+            wheel.time = Expiry::Now();
+        }
+    }
+    
+    // (Re)arms a node's timer for ttl ticks from now; ttl 0 leaves it without a deadline
+    inline void scheduleExpiry(IndexType idx, uint64_t now, uint64_t ttl) noexcept requires Expiry::ENABLED {
+        timerUnlink(idx);
+        if (ttl != 0) {
+            nodePool[idx].timer.deadline = now + ttl;
+            timerLink(idx);
+        }
+    }
+    
+    // Places a node in the slot of the highest 6-bit tick group in which its deadline
+    // differs from the wheel time; that slot is always ahead of the wheel in its level
+    inline void timerLink(IndexType idx) noexcept requires Expiry::ENABLED {
+        TimerLinks& timer = nodePool[idx].timer;
+        uint64_t differing = timer.deadline ^ wheel.time;
+        size_t level = differing == 0 ? 0 : (std::bit_width(differing) - 1) / WHEEL_SLOT_BITS;
+        size_t slot;
+        if (level < WHEEL_LEVELS) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            slot = (timer.deadline >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1);
+        } else {
+            // Beyond the wheel's range: park in top-level slot 0, which comes due at the
+            // start of the next rotation, and re-place it then
+            level = WHEEL_LEVELS - 1;
+            slot = 0;
+        }
+        size_t id = level * WHEEL_SLOTS + slot;
+        timer.slot = static_cast<uint16_t>(id);
+        timer.prev = NIL;
+        timer.next = wheel.heads[id];
+        if (timer.next != NIL) {
+            nodePool[timer.next].timer.prev = idx;
+        }
+        wheel.heads[id] = idx;
+        wheel.occupied[level] |= uint64_t{1} << slot;
+    }
+    
+    inline void timerUnlink(IndexType idx) noexcept requires Expiry::ENABLED {
+        TimerLinks& timer = nodePool[idx].timer;
+        if (timer.slot == NO_TIMER) {
+            return;
+        }
+        if (timer.prev != NIL) {
+            nodePool[timer.prev].timer.next = timer.next;
+        } else {
+            wheel.heads[timer.slot] = timer.next;
+            if (timer.next == NIL) {
+                wheel.occupied[timer.slot / WHEEL_SLOTS] &= ~(uint64_t{1} << (timer.slot % WHEEL_SLOTS));
+            }
+        }
+        if (timer.next != NIL) {
+            nodePool[timer.next].timer.prev = timer.prev;
+        }
+        timer.slot = NO_TIMER;
+    }
+    
+    // Earliest tick at which an occupied slot is due, or UINT64_MAX for an empty wheel
+    inline uint64_t nextTimerEvent() const noexcept requires Expiry::ENABLED {
+        uint64_t next = std::numeric_limits<uint64_t>::max();
+        for (size_t level = 0; level < WHEEL_LEVELS; ++level) {
+            uint64_t bits = wheel.occupied[level];
+            if (bits == 0) {
+                continue;
+            }
+            unsigned shift = WHEEL_SLOT_BITS * static_cast<unsigned>(level);
+            uint64_t current = (wheel.time >> shift) & (WHEEL_SLOTS - 1);
+            uint64_t ahead = current == WHEEL_SLOTS - 1 ? 0 : bits & (~uint64_t{0} << (current + 1));
+            uint64_t rotation = (wheel.time >> (shift + WHEEL_SLOT_BITS)) << (shift + WHEEL_SLOT_BITS);
+            uint64_t due = ahead != 0
+                ? rotation | (static_cast<uint64_t>(std::countr_zero(ahead)) << shift)
+                : rotation + (uint64_t{1} << (shift + WHEEL_SLOT_BITS))
+                      + (static_cast<uint64_t>(std::countr_zero(bits)) << shift);
+            next = std::min(next, due);
+        }
+        return next;
+    }
+    
+    // Detaches a slot's list and either expires each node or re-places it further down
+    inline size_t drainSlot(size_t level, size_t slot) noexcept requires Expiry::ENABLED {
+        size_t id = level * WHEEL_SLOTS + slot;
+        IndexType idx = wheel.heads[id];
+        wheel.heads[id] = NIL;
+        wheel.occupied[level] &= ~(uint64_t{1} << slot);
+        size_t expiredCount = 0;
+        while (idx != NIL) {
+            TimerLinks& timer = nodePool[idx].timer;
+            IndexType next = timer.next;
+            timer.slot = NO_TIMER;
+            if (timer.deadline <= wheel.time) {
+                expire(idx, nodeHash(idx));
+                ++expiredCount;
+            } else {
+                timerLink(idx);
+            }
+            idx = next;
+        }
+        return expiredCount;
+    }
+    
+    // Processes every slot due up to now: cascades higher levels whose slot starts at the
+    // tick, then expires the level-0 slot. Returns the number of entries expired.
+    size_t advanceTimers(uint64_t now) noexcept requires Expiry::ENABLED {
+        size_t expiredCount = 0;
+        while (wheel.time < now) {
+            uint64_t next = nextTimerEvent();
+            if (next > now) {
+                wheel.time = now;
+                break;
+            }
+            wheel.time = next;
+            for (size_t level = WHEEL_LEVELS - 1; level > 0; --level) {
+                unsigned shift = WHEEL_SLOT_BITS * static_cast<unsigned>(level);
+                if ((next & ((uint64_t{1} << shift) - 1)) == 0) {
+                    expiredCount += drainSlot(level, (next >> shift) & (WHEEL_SLOTS - 1));
+                }
+            }
+            expiredCount += drainSlot(0, next & (WHEEL_SLOTS - 1));
+        }
+        return expiredCount;
+    }
+    
+    // The admission window takes a pool bucket that is never linked into the frequency list
+    void resetWindow() {
+        if constexpr (Admission::ENABLED) {
+            admission.Reset(capacity());
+            windowBucket = static_cast<IndexType>(bucketPoolSize++);
+            bucketPool[windowBucket] = FrequencyList{0, NIL, NIL, NIL, NIL};
+        }
+        windowCount = 0;
+    }
+    
+    // Sizes the eviction policy's per-slot state; the only allocation it ever makes
+    void resetEviction() {
+        if constexpr (Eviction::ENABLED) {
+            eviction.Reset(capacity());
+        }
+    }
+    
+    // W-TinyLFU: make room by letting the window's LRU entry compete with the LFU victim
+    inline void admitFromWindow() noexcept {
+        IndexType candidate = bucketPool[windowBucket].tail;
+        unlink(candidate);
+        --windowCount;
+        
+        if (count - windowCount <= capacity() - Admission::WindowCapacity(capacity())) {
+            // Main region has room (only reachable while the cache is still filling)
+            linkToFirstBucket(candidate);
+            return;
+        }
+        
+        uint32_t candidateHash = nodeHash(candidate);
+        IndexType victim = minBucket != NIL ? bucketPool[minBucket].tail : NIL;
+        if (victim != NIL) {
+            uint32_t victimHash = nodeHash(victim);
+            if (admission.Admit(candidateHash, victimHash)) {
+                ageTo(bucketPool[minBucket].frequency);
+                evict(victim, victimHash);
+                linkToFirstBucket(candidate);
+                return;
+            }
+        }
+        
+        // Rejected: the candidate leaves the cache (it is already unlinked)
+        if constexpr (Stats::ENABLED) {
+            stats.RecordEviction(0);
+        }
+        keyIndex.Erase(candidateHash, candidate);
+        releaseEvicted(candidate);
+        --count;
+    }
+    
+    // Put() with the key's mixed hash already computed; the key and value are moved in
+    // when passed as rvalues
+    template<typename K, typename V>
+    inline IndexType putHashed(K&& key, V&& value, uint32_t hash) noexcept {
+        [[maybe_unused]] uint64_t start = startTimer();
+        if constexpr (Admission::ENABLED) {
+            admission.Record(hash);
+        }
+        IndexType idx = findLiveIndex(key, hash);
+        if (idx != NIL) [[likely]] {  // OPTIMIZATION: Branch prediction hint - cache updates are common
+            // Update existing key
+            nodePool[idx].value = std::forward<V>(value);
+            touch(idx);
+            if constexpr (Weigher::ENABLED) {
+                chargeWeight(idx);
+            }
+            if constexpr (Expiry::ENABLED) {
+                scheduleExpiry(idx, Expiry::Now(), wheel.defaultTtl);
+            }
+            if constexpr (Stats::ENABLED) {
+                stats.RecordUpdate();
+            }
+            recordLatency(LFUOperation::PutUpdate, start);
+            return idx;
+        }
+        [[maybe_unused]] LFUOperation operation = insertOperation();
+        idx = insertNew(std::forward<K>(key), hash, std::forward<V>(value));
+        recordLatency(operation, start);
+        return idx;
+    }
+    
+    // Emplace()/TryEmplace(): a new key constructs its value in the pool slot; an existing
+    // key is refreshed and, unless tryOnly, gets a value built from the same arguments.
+    // Returns whether the key was inserted.
+    template<typename K, typename... Args>
+    inline bool emplaceHashed(K&& key, uint32_t hash, bool tryOnly, Args&&... args) noexcept {
+        [[maybe_unused]] uint64_t start = startTimer();
+        if constexpr (Admission::ENABLED) {
+            admission.Record(hash);
+        }
+        IndexType idx = findLiveIndex(key, hash);
+        if (idx != NIL) {
+            if (!tryOnly) {
+                nodePool[idx].value = Value(std::forward<Args>(args)...);
+            }
+            touch(idx);
+            if constexpr (Weigher::ENABLED) {
+                if (!tryOnly) {
+                    chargeWeight(idx);
+                }
+            }
+            if constexpr (Expiry::ENABLED) {
+                if (!tryOnly) {
+                    scheduleExpiry(idx, Expiry::Now(), wheel.defaultTtl);
+                }
+            }
+            if constexpr (Stats::ENABLED) {
+                if (!tryOnly) {
+                    stats.RecordUpdate();
+                }
+            }
+            recordLatency(LFUOperation::PutUpdate, start);
+            return false;
+        }
+        [[maybe_unused]] LFUOperation operation = insertOperation();
+        insertNew(std::forward<K>(key), hash, std::forward<Args>(args)...);
+        recordLatency(operation, start);
+        return true;
+    }
+    
+    // Inserts a key known to be absent, evicting first if the cache is full; returns its slot
+    template<typename K, typename... Args>
+    inline IndexType insertNew(K&& key, uint32_t hash, Args&&... args) noexcept {
+        if constexpr (Expiry::ENABLED) {
+            // Expired entries are reclaimed first, so they make room before any LFU victim
+            advanceTimers(Expiry::Now());
+        }
+        if constexpr (Stats::ENABLED) {
+            stats.RecordInsert();
+        }
+        if constexpr (Admission::ENABLED) {
+            // New keys enter the LRU window; a full window hands its LRU entry to admission
+            if (windowCount >= Admission::WindowCapacity(capacity())) {
+                admitFromWindow();
+            }
+            if (count >= capacity()) [[unlikely]] {
+                // Window below its share (capacity 1): fall back to plain LFU eviction
+                IndexType victim = bucketPool[minBucket].tail;
+                ageTo(bucketPool[minBucket].frequency);
+                evict(victim, nodeHash(victim));
+            }
+            IndexType newIdx = allocateNode(hash, std::forward<K>(key), std::forward<Args>(args)...);
+            keyIndex.Insert(hash, newIdx);
+            ++count;
+            linkToHead(windowBucket, newIdx);
+            ++windowCount;
+            if constexpr (Expiry::ENABLED) {
+                scheduleExpiry(newIdx, wheel.time, wheel.defaultTtl);
+            }
+            return newIdx;
+        }
+        
+        // Add new key - check capacity
+        if (count >= capacity()) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            if constexpr (Eviction::ENABLED) {
+                IndexType victim = static_cast<IndexType>(eviction.Victim(hash));
+                evict(victim, nodeHash(victim));
+            } else {
+                // Remove least recently used item of the least frequently used bucket
+                IndexType lru = bucketPool[minBucket].tail;
+                ageTo(bucketPool[minBucket].frequency);
+                evict(lru, nodeHash(lru));
+            }
+        }
+        
+        // Add new node to the frequency-1 bucket (or hand it to the eviction policy)
+        IndexType newIdx = allocateNode(hash, std::forward<K>(key), std::forward<Args>(args)...);
+        keyIndex.Insert(hash, newIdx);
+        ++count;
+        if constexpr (Eviction::ENABLED) {
+            eviction.OnInsert(newIdx, hash);
+        } else {
+            linkToFirstBucket(newIdx);
+        }
+        if constexpr (Weigher::ENABLED) {
+            chargeWeight(newIdx);
+        }
+        if constexpr (Expiry::ENABLED) {
+            scheduleExpiry(newIdx, wheel.time, wheel.defaultTtl);
+        }
+        return newIdx;
+    }
+    
+    // Two prefetch passes over a batch: home index slots, then the first candidate node
+    // of each probe run (which needs the slot, hence the separate pass)
+    inline void prefetchBatch(std::span<const Key> keys, uint32_t* hashes) const noexcept {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            hashes[i] = hashOf(keys[i]);
+            keyIndex.Prefetch(hashes[i]);
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+            uint32_t candidate = keyIndex.Candidate(hashes[i]);
+            if (candidate != LFUFlatIndex<MAX_SIZE>::NOT_FOUND) {
+                LFUPrefetch(&nodePool[candidate]);
+            }
+        }
+    }
+    
+    // Snapshot format: this header, then per bucket (highest frequency first) an int32
+    // frequency, a uint32 entry count and the entries, key then value
+    static constexpr uint64_t SNAPSHOT_MAGIC = 0x50414E5355464CULL;  // "LFUSNAP"
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+    static constexpr size_t SNAPSHOT_CHUNK_BYTES = 4096;
+    
+    struct SnapshotHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t keyBytes;      // sizeof(Key), or 0 for a length-prefixed std::string
+        uint32_t valueBytes;
+        uint32_t flags;         // Bit 0: dynamic aging
+        int32_t cacheAge;
+        uint32_t bucketCount;
+        uint64_t entryCount;
+    };
+    
+    template<typename T>
+    static constexpr uint32_t snapshotBytes() noexcept {
+        return std::is_trivially_copyable_v<T> ? static_cast<uint32_t>(sizeof(T)) : 0;
+    }
+    
+    static void writeSnapshot(std::streambuf* out, const void* data, size_t bytes) {
+        if (!out || out->sputn(static_cast<const char*>(data), static_cast<std::streamsize>(bytes))
+                        != static_cast<std::streamsize>(bytes)) [[unlikely]] {
+            throw std::runtime_error("LFUCache snapshot: write failed");
+        }
+    }
+    
+    static void readSnapshot(std::streambuf* in, void* data, size_t bytes) {
+        if (!in || in->sgetn(static_cast<char*>(data), static_cast<std::streamsize>(bytes))
+                       != static_cast<std::streamsize>(bytes)) [[unlikely]] {
+            throw std::runtime_error("LFUCache snapshot: truncated");
+        }
+    }
+    
+    template<typename T>
+    static void writeField(std::streambuf* out, const T& field) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            writeSnapshot(out, &field, sizeof(T));
+        } else {
+            uint64_t length = field.size();
+            writeSnapshot(out, &length, sizeof(length));
+            writeSnapshot(out, field.data(), field.size());
+        }
+    }
+    
+    template<typename T>
+    static void readField(std::streambuf* in, T& field) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            readSnapshot(in, &field, sizeof(T));
+        } else {
+            uint64_t length;
+            readSnapshot(in, &length, sizeof(length));
+            field.resize(length);
+            readSnapshot(in, field.data(), length);
+        }
+    }
+    
+    // Adds one snapshot entry at the LRU end of the bucket being rebuilt (created on first
+    // use, in front of every bucket so far), unless the cache or weight budget is full
+    inline void loadEntry(IndexType& bucketIdx, int frequency, uint32_t hash, Key& key, Value& value) {
+        if (count == capacity()) {
+            return;  // Full: the remaining, less frequent entries are skipped
+        }
+        if constexpr (Weigher::ENABLED) {
+            if (weigher(key, value) > maxWeight - totalWeight) {
+                return;
+            }
+        }
+        if (findIndex(key, hash) != NIL) [[unlikely]] {
+            throw std::runtime_error("LFUCache snapshot: duplicate key");
+        }
+        if (bucketIdx == NIL) {
+            bucketIdx = allocateBucket(frequency, NIL);
+        }
+        IndexType idx = allocateNode(hash, std::move(key), std::move(value));
+        keyIndex.Insert(hash, idx);
+        linkToTail(bucketIdx, idx);
+        ++count;
+        if constexpr (Weigher::ENABLED) {
+            nodePool[idx].weight = weigher(nodePool[idx].key, nodePool[idx].value);
+            totalWeight += nodePool[idx].weight;
+        }
+        if constexpr (Expiry::ENABLED) {
+            scheduleExpiry(idx, wheel.time, wheel.defaultTtl);
+        }
+    }
+    
+    // Buckets arrive highest frequency first, so each one is linked in front of the last
+    // and each entry at its bucket's LRU end; reading stops adding once the cache is full
+    void loadSnapshot(std::streambuf* in) {
+        SnapshotHeader header;
+        readSnapshot(in, &header, sizeof(header));
+        if (header.magic != SNAPSHOT_MAGIC) {
+            throw std::runtime_error("LFUCache snapshot: bad magic");
+        }
+        if (header.version != SNAPSHOT_VERSION || header.keyBytes != snapshotBytes<Key>()
+            || header.valueBytes != snapshotBytes<Value>()) {
+            throw std::runtime_error("LFUCache snapshot: incompatible format");
+        }
+        if (header.cacheAge < 0) {
+            throw std::runtime_error("LFUCache snapshot: corrupt header");
+        }
+        dynamicAging = (header.flags & 1) != 0;
+        cacheAge = dynamicAging ? header.cacheAge : 0;
+        
+        int previousFrequency = std::numeric_limits<int>::max();
+        uint64_t entriesRead = 0;
+        Key key{};
+        Value value{};
+        for (uint32_t b = 0; b < header.bucketCount; ++b) {
+            int32_t frequency;
+            uint32_t entries;
+            readSnapshot(in, &frequency, sizeof(frequency));
+            readSnapshot(in, &entries, sizeof(entries));
+            if (frequency >= previousFrequency || frequency < cacheAge || entries == 0) {
+                throw std::runtime_error("LFUCache snapshot: corrupt bucket list");
+            }
+            previousFrequency = frequency;
+            IndexType bucketIdx = NIL;
+            if constexpr (std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>) {
+                // OPTIMIZATION: One read per SNAPSHOT_CHUNK_BYTES of fixed-size entries; within a
+                // chunk, each batch of keys has its index slots prefetched before it is inserted
+                // (as in MultiGet)
+                constexpr size_t ENTRY_BYTES = sizeof(Key) + sizeof(Value);
+                constexpr size_t CHUNK = std::max<size_t>(SNAPSHOT_CHUNK_BYTES / ENTRY_BYTES, 1);
+                std::byte chunk[CHUNK * ENTRY_BYTES];
+                uint32_t hashes[PREFETCH_BATCH];
+                for (uint32_t done = 0; done < entries;) {
+                    size_t chunkEntries = std::min<size_t>(CHUNK, entries - done);
+                    readSnapshot(in, chunk, chunkEntries * ENTRY_BYTES);
+                    for (size_t base = 0; base < chunkEntries; base += PREFETCH_BATCH) {
+                        size_t batch = std::min(PREFETCH_BATCH, chunkEntries - base);
+                        const std::byte* entry = chunk + base * ENTRY_BYTES;
+                        for (size_t i = 0; i < batch; ++i) {
+                            std::memcpy(&key, entry + i * ENTRY_BYTES, sizeof(Key));
+                            hashes[i] = hashOf(key);
+                            keyIndex.Prefetch(hashes[i]);
+                        }
+                        for (size_t i = 0; i < batch; ++i) {
+                            std::memcpy(&key, entry + i * ENTRY_BYTES, sizeof(Key));
+                            std::memcpy(&value, entry + i * ENTRY_BYTES + sizeof(Key), sizeof(Value));
+                            loadEntry(bucketIdx, frequency, hashes[i], key, value);
+                        }
+                    }
+                    done += static_cast<uint32_t>(chunkEntries);
+                }
+            } else {
+                for (uint32_t e = 0; e < entries; ++e) {
+                    readField(in, key);
+                    readField(in, value);
+                    loadEntry(bucketIdx, frequency, hashOf(key), key, value);
+                }
+            }
+            entriesRead += entries;
+        }
+        if (entriesRead != header.entryCount) {
+            throw std::runtime_error("LFUCache snapshot: entry count mismatch");
+        }
+    }
+    
+public:
+    LFUCache() requires (!IS_DYNAMIC)
+        : poolSize(0), freeCount(0), count(0),
+          bucketPoolSize(0), freeBucketCount(0), minBucket(NIL), windowBucket(NIL), dynamicAging(false), cacheAge(0), dynamicCapacity(MAX_SIZE) {
+        
+        // OPTIMIZATION: Template-based compile-time validation
+        static_assert(MAX_SIZE > 0, "MAX_SIZE must be positive");
+        resetWindow();
+        resetEviction();
+        resetWheel();
+    }
+    
+    LFUCache(const LFUCache& other) requires (!IS_DYNAMIC) : dynamicCapacity(MAX_SIZE) {
+        copyFrom(other);
+    }
+    
+    LFUCache& operator=(const LFUCache& other) requires (!IS_DYNAMIC) {
+        if (this != &other) {
+            destroyNodes();
+            copyFrom(other);
+        }
+        return *this;
+    }
+    
+    // Runtime-capacity cache: every pool is allocated here, once, so Get/Put never allocate.
+    // Huge pages are a best-effort request; HugePages() reports whether they were obtained.
+    explicit LFUCache(size_t capacityValue, bool useHugePages = false) requires IS_DYNAMIC
+        : poolSize(0), freeCount(0), count(0),
+          bucketPoolSize(0), freeBucketCount(0), minBucket(NIL), windowBucket(NIL), dynamicAging(false), cacheAge(0), dynamicCapacity(capacityValue) {
+        if (capacityValue == 0 || capacityValue > LFUFlatIndex<MAX_SIZE>::MAX_CAPACITY) {
+            throw std::invalid_argument("LFUCache capacity must be between 1 and 2^31 - 2");
+        }
+        allocateRegion(capacityValue, useHugePages);
+        resetWindow();
+        resetEviction();
+        resetWheel();
+    }
+    
+    ~LFUCache() {
+        destroyNodes();
+    }
+    
+    // OPTIMIZATION: Hot path version - no exceptions for maximum performance
+    inline Value Get(const Key& key) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return Value{};  // Return default-constructed value for missing keys
+        }
+        return nodePool[idx].value;
+    }
+    
+    // Exception-throwing version for when you need error handling
+    inline Value GetOrThrow(const Key& key) {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            throw std::runtime_error("Key not found");
+        }
+        return nodePool[idx].value;
+    }
+    
+    // OPTIMIZATION: Force inlining of getOrDefault function (hot path) - already noexcept
+    inline Value GetOrDefault(const Key& key, const Value& defaultValue) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return defaultValue;
+        }
+        return nodePool[idx].value;
+    }
+    
+    // Single-probe hit/miss: copies the value into out and returns true on a hit, leaves out
+    // untouched on a miss. Replaces Contains() + Get(), which hashes and probes twice.
+    inline bool TryGet(const Key& key, Value& out) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return false;
+        }
+        out = nodePool[idx].value;
+        return true;
+    }
+    
+    // Single-probe lookup for values that are not default constructible or cheap to assign
+    inline std::optional<Value> TryGet(const Key& key) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return std::nullopt;
+        }
+        return nodePool[idx].value;
+    }
+    
+    // Zero-copy hit path: counts as a hit like Get() but returns a pointer into the cache
+    // (nullptr on a miss) instead of copying the value. Nodes never move, so the pointer
+    // stays valid until the entry is removed: any Put()/MultiPut() of a new key may evict
+    // it, as do Clear(), assignment and destruction. Lookups never invalidate it, and a
+    // Put() of the same key updates the pointed-to value in place.
+    inline const Value* Find(const Key& key) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return nullptr;
+        }
+        return &nodePool[idx].value;
+    }
+    
+    // Zero-copy hit path with no pointer escaping: on a hit, calls fn(const Value&) and
+    // returns true. The reference is only valid during the call, and fn must not modify
+    // the cache.
+    template<typename Fn>
+    inline bool Visit(const Key& key, Fn&& fn) noexcept(noexcept(fn(std::declval<const Value&>()))) {
+        const Value* value = Find(key);
+        if (value == nullptr) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return false;
+        }
+        fn(*value);
+        return true;
+    }
+    
+    // Heterogeneous lookups, available when Hash and KeyEqual are both transparent (e.g.
+    // LFUStringHash and std::equal_to<>): a std::string_view or string literal is hashed
+    // and compared as is, so no temporary Key is constructed. Same semantics as above.
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline Value Get(const K& key) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        return idx == NIL ? Value{} : nodePool[idx].value;
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline Value GetOrThrow(const K& key) {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            throw std::runtime_error("Key not found");
+        }
+        return nodePool[idx].value;
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline Value GetOrDefault(const K& key, const Value& defaultValue) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        return idx == NIL ? defaultValue : nodePool[idx].value;
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline bool TryGet(const K& key, Value& out) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return false;
+        }
+        out = nodePool[idx].value;
+        return true;
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline const Value* Find(const K& key) noexcept {
+        IndexType idx = lookup(key, hashOf(key));
+        return idx == NIL ? nullptr : &nodePool[idx].value;
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline bool Contains(const K& key) const noexcept {
+        return liveIndex(key) != NIL;
+    }
+    
+    // Read-through access with one hash and one index probe: a hit returns the cached value,
+    // a miss calls loader(key) and caches its result. Replaces Contains() + Put() + Get().
+    // If the loader throws, the exception propagates and nothing is cached. The loader must
+    // not modify this cache.
+    template<typename Loader>
+    Value GetOrCompute(const Key& key, Loader&& loader) {
+        uint32_t hash = hashOf(key);
+        IndexType idx = lookup(key, hash);
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            idx = insertNew(key, hash, loader(key));
+        }
+        return nodePool[idx].value;
+    }
+    
+    // OPTIMIZATION: Force inlining of contains function (hot path) - noexcept for performance
+    inline bool Contains(const Key& key) const noexcept {
+        return liveIndex(key) != NIL;
+    }
+    
+    // OPTIMIZATION: Hot path put - noexcept for maximum performance
+    void Put(const Key& key, const Value& value) noexcept {
+        putHashed(key, value, hashOf(key));
+    }
+    
+    // Move-aware Put(): rvalue keys and values are moved into the pool slot, so caching a
+    // freshly built std::string or std::vector performs no copy and no allocation
+    void Put(const Key& key, Value&& value) noexcept {
+        putHashed(key, std::move(value), hashOf(key));
+    }
     
-    struct Node {
-        // Hot fields first (accessed most frequently)
-        int frequency;         // Most accessed field
-        Node* prev;           // Pointer fields together  
-        Node* next;
-        Key key;
-        Value value;
-        
-        Node() : frequency(0), prev(nullptr), next(nullptr) {}
-        Node(const Key& k, const Value& v, int f) 
-            : frequency(f), prev(nullptr), next(nullptr), key(k), value(v) {}
-    };
+    void Put(Key&& key, Value&& value) noexcept {
+        uint32_t hash = hashOf(key);
+        putHashed(std::move(key), std::move(value), hash);
+    }
     
-    struct FrequencyList {
-        Node* head;
-        Node* tail;
-        int size;
-        
-        FrequencyList() : head(nullptr), tail(nullptr), size(0) {}
-        
-        // OPTIMIZATION: Force inlining of critical path functions
-        inline void AddToHead(Node* node) {
-            node->prev = nullptr;
-            node->next = head;
-            if (head) [[likely]] {  // OPTIMIZATION: Branch prediction hint
-                head->prev = node;
+    // Precomputed-hash entry points for callers that already hashed the key (e.g. to route
+    // it to a shard or server): hash must be Hash{}(key), which is checked in debug builds.
+    // Otherwise identical to Get()/TryGet()/Put().
+    inline Value GetWithHash(const Key& key, size_t hash) noexcept {
+        IndexType idx = lookup(key, mixHash(key, hash));
+        return idx == NIL ? Value{} : nodePool[idx].value;
+    }
+    
+    inline bool TryGetWithHash(const Key& key, size_t hash, Value& out) noexcept {
+        IndexType idx = lookup(key, mixHash(key, hash));
+        if (idx == NIL) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
+            return false;
+        }
+        out = nodePool[idx].value;
+        return true;
+    }
+    
+    void PutWithHash(const Key& key, size_t hash, const Value& value) noexcept {
+        putHashed(key, value, mixHash(key, hash));
+    }
+    
+    void PutWithHash(const Key& key, size_t hash, Value&& value) noexcept {
+        putHashed(key, std::move(value), mixHash(key, hash));
+    }
+    
+    // Inserts or overwrites key with a Value constructed from args. A new entry constructs
+    // the value directly in its pool slot; an existing one is assigned Value(args...).
+    // Returns true if the key was inserted.
+    template<typename... Args>
+    bool Emplace(const Key& key, Args&&... args) noexcept {
+        return emplaceHashed(key, hashOf(key), false, std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    bool Emplace(Key&& key, Args&&... args) noexcept {
+        uint32_t hash = hashOf(key);
+        return emplaceHashed(std::move(key), hash, false, std::forward<Args>(args)...);
+    }
+    
+    // Like std::map::try_emplace: constructs the value in place only if key is absent and
+    // otherwise leaves args untouched (an existing key still counts as an access).
+    // Returns true if the key was inserted.
+    template<typename... Args>
+    bool TryEmplace(const Key& key, Args&&... args) noexcept {
+        return emplaceHashed(key, hashOf(key), true, std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    bool TryEmplace(Key&& key, Args&&... args) noexcept {
+        uint32_t hash = hashOf(key);
+        return emplaceHashed(std::move(key), hash, true, std::forward<Args>(args)...);
+    }
+    
+    // Batched lookups with the same per-key semantics as Get(): hits refresh frequency,
+    // found[i] reports whether keys[i] was cached, and values[i] is written only on a hit.
+    // Keys are hashed and their index slots and likely nodes prefetched a batch at a time
+    // before any is resolved, so independent cache misses overlap instead of serializing.
+    void MultiGet(std::span<const Key> keys, std::span<Value> values, std::span<bool> found) noexcept {
+        assert(values.size() >= keys.size() && found.size() >= keys.size());
+        uint32_t hashes[PREFETCH_BATCH];
+        for (size_t base = 0; base < keys.size(); base += PREFETCH_BATCH) {
+            size_t batch = std::min(PREFETCH_BATCH, keys.size() - base);
+            prefetchBatch(keys.subspan(base, batch), hashes);
+            for (size_t i = 0; i < batch; ++i) {
+                IndexType idx = lookup(keys[base + i], hashes[i]);
+                found[base + i] = idx != NIL;
+                if (idx != NIL) {
+                    values[base + i] = nodePool[idx].value;
+                }
             }
-            head = node;
-            if (!tail) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
-                tail = node;
+        }
+    }
+    
+    // Batched Put(): values[i] is stored under keys[i], in order, so later duplicates win
+    void MultiPut(std::span<const Key> keys, std::span<const Value> values) noexcept {
+        assert(values.size() >= keys.size());
+        uint32_t hashes[PREFETCH_BATCH];
+        for (size_t base = 0; base < keys.size(); base += PREFETCH_BATCH) {
+            size_t batch = std::min(PREFETCH_BATCH, keys.size() - base);
+            prefetchBatch(keys.subspan(base, batch), hashes);
+            for (size_t i = 0; i < batch; ++i) {
+                putHashed(keys[base + i], values[base + i], hashes[i]);
             }
-            size++;
         }
+    }
+    
+    // OPTIMIZATION: Force inlining of simple getters - noexcept for performance
+    inline int Size() const noexcept {
+        return static_cast<int>(count);
+    }
+    
+    inline constexpr size_t Capacity() const noexcept {
+        return capacity();
+    }
+    
+    // Default time-to-live for entries written by Put()/Emplace()/GetOrCompute() and friends,
+    // counted from each write (a zero TTL, the default, means they never expire)
+    template<typename Rep, typename Period>
+    void SetDefaultTTL(std::chrono::duration<Rep, Period> ttl) noexcept requires Expiry::ENABLED {
+        wheel.defaultTtl = Expiry::Ticks(ttl);
+    }
+    
+    // Put() with a per-entry TTL overriding the default one
+    template<typename Rep, typename Period>
+    void PutWithTTL(const Key& key, const Value& value, std::chrono::duration<Rep, Period> ttl) noexcept
+        requires Expiry::ENABLED {
+        IndexType idx = putHashed(key, value, hashOf(key));
+        scheduleExpiry(idx, Expiry::Now(), Expiry::Ticks(ttl));
+    }
+    
+    template<typename Rep, typename Period>
+    void PutWithTTL(const Key& key, Value&& value, std::chrono::duration<Rep, Period> ttl) noexcept
+        requires Expiry::ENABLED {
+        IndexType idx = putHashed(key, std::move(value), hashOf(key));
+        scheduleExpiry(idx, Expiry::Now(), Expiry::Ticks(ttl));
+    }
+    
+    // Reclaims every entry whose deadline has passed (inserts do this automatically);
+    // returns how many were removed
+    size_t PurgeExpired() noexcept requires Expiry::ENABLED {
+        return advanceTimers(Expiry::Now());
+    }
+    
+    // Copy of the counters so far (caches with a Stats policy such as LFUCountingStats)
+    inline LFUCacheStats Statistics() const noexcept requires Stats::ENABLED {
+        return stats.Snapshot();
+    }
+    
+    inline void ResetStatistics() noexcept requires Stats::ENABLED {
+        stats.Reset();
+    }
+    
+    // Latency histogram of one operation class (timed Stats policies such as LFULatencyStats)
+    inline const LFULatencyHistogram& Latency(LFUOperation operation) const noexcept requires Stats::TIMED {
+        return stats.Latency(operation);
+    }
+    
+    // Sum of the weights of all entries (weighted caches; see Weigher)
+    inline size_t Weight() const noexcept requires Weigher::ENABLED {
+        return totalWeight;
+    }
+    
+    inline size_t MaxWeight() const noexcept requires Weigher::ENABLED {
+        return maxWeight;
+    }
+    
+    // Weight budget on top of the entry-count capacity; lowering it evicts immediately
+    void SetMaxWeight(size_t budget) noexcept requires Weigher::ENABLED {
+        maxWeight = budget;
+        shrinkToBudget(NIL);
+    }
+    
+    // The eviction policy instance, e.g. to inspect ARCEviction::Target()
+    inline const Eviction& EvictionPolicy() const noexcept requires Eviction::ENABLED {
+        return eviction;
+    }
+    
+    // The eviction listener instance, e.g. to point it at a buffer pool after construction
+    inline EvictionListener& Listener() noexcept {
+        return listener;
+    }
+    
+    // Whether the pools of a runtime-capacity cache are backed by huge pages
+    inline bool HugePages() const noexcept {
+        return region.HugePages();
+    }
+    
+    // With dynamic aging this is the lowest aged priority rather than a raw hit count
+    inline int MinFrequency() const noexcept requires (!Eviction::ENABLED) {
+        return minBucket != NIL ? bucketPool[minBucket].frequency : 0;
+    }
+    
+    // LFU-DA frequency aging, off by default. When on, each eviction raises the cache
+    // age to the victim's frequency and new entries start at age + 1, so keys that were
+    // hot long ago are eventually outranked by the current working set. O(1) per
+    // operation; turning it off resets the age and new entries start at 1 again.
+    inline void SetDynamicAging(bool enabled) noexcept requires (!Eviction::ENABLED) {
+        dynamicAging = enabled;
+        if (!enabled) {
+            cacheAge = 0;
+        }
+    }
+    
+    inline bool DynamicAging() const noexcept {
+        return dynamicAging;
+    }
+    
+    void Clear() noexcept {
+        destroyNodes();
+        keyIndex.Clear();
+        count = 0;
         
-        // OPTIMIZATION: Force inlining of critical path functions
-        inline void Remove(Node* node) {
-            if (node->prev) [[likely]] {  // OPTIMIZATION: Branch prediction hint
-                node->prev->next = node->next;
+        // Every slot is free again: restart the bump allocators with empty free lists
+        freeCount = 0;
+        poolSize = 0;
+        freeBucketCount = 0;
+        bucketPoolSize = 0;
+        minBucket = NIL;
+        cacheAge = 0;
+        totalWeight = 0;
+        resetWindow();
+        resetEviction();
+        resetWheel();
+    }
+    
+    // Writes every entry with its frequency in a versioned binary format (native byte order):
+    // a header, then each frequency bucket from the highest down with its entries from most
+    // to least recently used. Expired entries not yet reclaimed are left out, so a reload
+    // cannot revive them. Throws std::runtime_error if the stream cannot be written.
+    void SaveSnapshot(std::ostream& out) const
+        requires (LFUSnapshotField<Key> && LFUSnapshotField<Value> && !Admission::ENABLED && !Eviction::ENABLED) {
+        std::streambuf* buffer = out.rdbuf();
+        [[maybe_unused]] uint64_t now = 0;
+        if constexpr (Expiry::ENABLED) {
+            now = Expiry::Now();
+        }
+        auto live = [&](IndexType i) {
+            if constexpr (Expiry::ENABLED) {
+                return !expired(i, now);
             } else {
-                head = node->next;
+                return true;
             }
-            if (node->next) [[likely]] {  // OPTIMIZATION: Branch prediction hint
-                node->next->prev = node->prev;
-            } else {
-                tail = node->prev;
+        };
+        auto liveEntries = [&](IndexType b) {
+            uint32_t entries = 0;
+            for (IndexType i = bucketPool[b].head; i != NIL; i = nodePool[i].next) {
+                entries += live(i) ? 1 : 0;
             }
-            node->prev = node->next = nullptr;
-            size--;
-        }
+            return entries;
+        };
         
-        // OPTIMIZATION: Force inlining of simple getter
-        inline bool Empty() const { return size == 0; }
-    };
-    
-    int minFrequency;
+        // The header comes first, so count what will be written: buckets left empty by
+        // expired entries are dropped
+        IndexType last = NIL;
+        uint32_t bucketCount = 0;
+        uint64_t entryCount = 0;
+        for (IndexType b = minBucket; b != NIL; b = bucketPool[b].next) {
+            uint32_t entries = liveEntries(b);
+            bucketCount += entries != 0 ? 1 : 0;
+            entryCount += entries;
+            last = b;
+        }
+        SnapshotHeader header{SNAPSHOT_MAGIC, SNAPSHOT_VERSION, snapshotBytes<Key>(), snapshotBytes<Value>(),
+                              dynamicAging ? 1u : 0u, cacheAge, bucketCount, entryCount};
+        writeSnapshot(buffer, &header, sizeof(header));
+        for (IndexType b = last; b != NIL; b = bucketPool[b].prev) {
+            uint32_t entries = liveEntries(b);
+            if (entries == 0) {
+                continue;
+            }
+            writeSnapshot(buffer, &bucketPool[b].frequency, sizeof(int32_t));
+            writeSnapshot(buffer, &entries, sizeof(entries));
+            for (IndexType i = bucketPool[b].head; i != NIL; i = nodePool[i].next) {
+                if (live(i)) {
+                    writeField(buffer, nodePool[i].key);
+                    writeField(buffer, nodePool[i].value);
+                }
+            }
+        }
+        if (buffer->pubsync() != 0) {
+            throw std::runtime_error("LFUCache snapshot: write failed");
+        }
+    }
     
-    // Fixed-size memory pool for maximum performance
-    std::array<Node, MAX_SIZE> nodePool;
-    std::array<int, MAX_SIZE> freeNodes;
-    int poolSize;
-    int freeCount;
+    // Replaces the contents with a snapshot in one pass, rebuilding buckets, recency order
+    // and the index directly (no per-entry Put(), so frequencies are kept). If the snapshot
+    // holds more than fits, the least frequently used entries are skipped. Entries get the
+    // default TTL, if any. Throws std::runtime_error on a truncated, corrupt or incompatible
+    // snapshot, leaving the cache empty.
+    void LoadSnapshot(std::istream& in)
+        requires (LFUSnapshotField<Key> && LFUSnapshotField<Value> && !Admission::ENABLED && !Eviction::ENABLED) {
+        Clear();
+        try {
+            loadSnapshot(in.rdbuf());
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
     
-    std::unordered_map<Key, Node*, Hash> keyToNode;
-    std::unordered_map<int, FrequencyList> frequencyToList;
+    // Debug function with optimization hints
+    void PrintState() const {
+        std::cout << "Cache State (size=" << Size() << ", capacity=" << Capacity() << "):\n";
+        if constexpr (Eviction::ENABLED) {
+            std::cout << "  Entries: ";
+            forEachNode([&](IndexType i) { std::cout << "(" << nodePool[i].key << "," << nodePool[i].value << ") "; });
+            std::cout << "\n";
+            return;
+        }
+        if constexpr (Admission::ENABLED) {
+            std::cout << "  Window: ";
+            for (IndexType current = bucketPool[windowBucket].head; current != NIL; current = nodePool[current].next) {
+                std::cout << "(" << nodePool[current].key << "," << nodePool[current].value << ") ";
+            }
+            std::cout << "\n";
+        }
+        for (IndexType b = minBucket; b != NIL; b = bucketPool[b].next) {
+            std::cout << "  Freq " << bucketPool[b].frequency << ": ";
+            IndexType current = bucketPool[b].head;
+            while (current != NIL) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+                std::cout << "(" << nodePool[current].key << "," << nodePool[current].value << ") ";
+                current = nodePool[current].next;
+            }
+            std::cout << "\n";
+        }
+        std::cout << "  Min frequency: " << MinFrequency() << "\n";
+    }
+};
+
+// Runtime-capacity LFU cache with the same API, sized from configuration at startup
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Admission = LFUAlwaysAdmit,
+         typename KeyEqual = std::equal_to<Key>, typename EvictionListener = LFUNoEvictionListener,
+         typename Weigher = LFUUnitWeigher, typename Expiry = LFUNoExpiry, typename Stats = LFUNoStats,
+         typename Eviction = LFUEviction>
+using DynamicLFUCache = LFUCache<Key, Value, LFU_DYNAMIC_CAPACITY, Hash, Admission, KeyEqual, EvictionListener, Weigher,
+                                 Expiry, Stats, Eviction>;
+
+#ifdef LFU_CACHE_HAS_MMAP
+// Fixed-capacity LFU cache living in a shared file mapping, so a restarted process maps
+// the file and resumes with every entry and frequency intact instead of re-warming.
+// A fixed-capacity LFUCache already keeps all of its state inline and links nodes, buckets
+// and index slots by pool index, so the mapped bytes are valid at any address; only types
+// with no pointers or heap state qualify (trivially copyable keys and values, stateless
+// policies, no TinyLFU sketch). The file is reused only if it was closed cleanly by a
+// build with the same layout and schemaVersion; otherwise the cache starts empty. Bump
+// schemaVersion whenever the meaning of keys or values, or the Hash, changes.
+template<typename Key, typename Value, size_t MAX_SIZE, typename Hash = std::hash<Key>,
+         typename KeyEqual = std::equal_to<Key>, typename EvictionListener = LFUNoEvictionListener,
+         typename Weigher = LFUUnitWeigher, typename Expiry = LFUNoExpiry, typename Stats = LFUNoStats>
+class PersistentLFUCache {
+public:
+    using Cache =
+        LFUCache<Key, Value, MAX_SIZE, Hash, LFUAlwaysAdmit, KeyEqual, EvictionListener, Weigher, Expiry, Stats>;
     
 private:
-    // OPTIMIZATION: Force inlining of allocation functions (hot path)
-    inline Node* allocateNode(const Key& key, const Value& value, int frequency) {
-        if (freeCount > 0) [[likely]] {  // OPTIMIZATION: Branch prediction hint
-            // Reuse freed slot
-            --freeCount;
-            int idx = freeNodes[freeCount];
-            Node* node = &nodePool[idx];
-            *node = Node(key, value, frequency);
-            return node;
+    static constexpr bool persistentClock() noexcept {
+        if constexpr (Expiry::ENABLED) {
+            return std::is_same_v<typename Expiry::ClockType, std::chrono::system_clock>;
+        } else {
+            return true;
         }
-        
-        // OPTIMIZATION: Template specialization opportunity for compile-time bounds check
-        if constexpr (MAX_SIZE > 0) {
-            if (poolSize >= static_cast<int>(MAX_SIZE)) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
-                throw std::runtime_error("Node pool exhausted - increase MAX_SIZE template parameter");
+    }
+    
+    static_assert(MAX_SIZE != LFU_DYNAMIC_CAPACITY, "PersistentLFUCache requires a compile-time capacity");
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "PersistentLFUCache requires trivially copyable Key and Value types");
+    static_assert(std::is_empty_v<Hash> && std::is_empty_v<KeyEqual> && std::is_empty_v<EvictionListener>
+                  && std::is_empty_v<Weigher>, "PersistentLFUCache requires stateless policies");
+    static_assert(std::is_trivially_copyable_v<Stats>, "PersistentLFUCache requires a trivially copyable Stats policy");
+    static_assert(persistentClock(), "Expiring persistent caches must use std::chrono::system_clock");
+    
+    static constexpr uint64_t MAGIC = 0x314843414355464CULL;    // "LFUCACH1"
+    static constexpr uint32_t FORMAT_VERSION = 1;               // Bump when LFUCache's layout changes
+    static constexpr uint32_t STATE_CLOSED = 0x434C4F53;        // Written only by a clean close
+    static constexpr uint32_t STATE_OPEN = 0x4F50454E;
+    static constexpr size_t CACHE_OFFSET = 4096;                // Header page, then the cache
+    static constexpr size_t FILE_BYTES = CACHE_OFFSET + sizeof(Cache);
+    static_assert(alignof(Cache) <= CACHE_OFFSET);
+    
+    struct Header {
+        uint64_t magic;
+        uint32_t formatVersion;
+        uint32_t state;
+        uint64_t schemaVersion;
+        uint64_t cacheBytes;
+        uint64_t capacity;
+        uint32_t keyBytes;
+        uint32_t valueBytes;
+    };
+    
+public:
+    // Opens or creates the backing file; throws std::system_error if it cannot be opened,
+    // sized, locked or mapped (one process at a time may hold the file)
+    explicit PersistentLFUCache(const std::string& path, uint64_t schemaVersion = 0) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "PersistentLFUCache: open " + path);
+        }
+        try {
+            if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+                throw std::system_error(errno, std::generic_category(), "PersistentLFUCache: lock " + path);
+            }
+            struct stat info{};
+            if (::fstat(fd, &info) != 0) {
+                throw std::system_error(errno, std::generic_category(), "PersistentLFUCache: stat " + path);
+            }
+            bool sized = static_cast<size_t>(info.st_size) == FILE_BYTES;
+            if (!sized && ::ftruncate(fd, static_cast<off_t>(FILE_BYTES)) != 0) {
+                throw std::system_error(errno, std::generic_category(), "PersistentLFUCache: resize " + path);
             }
+            void* mapped = ::mmap(nullptr, FILE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapped == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "PersistentLFUCache: map " + path);
+            }
+            base = static_cast<std::byte*>(mapped);
+            
+            Header* header = headerPtr();
+            restored = sized && header->magic == MAGIC && header->formatVersion == FORMAT_VERSION
+                && header->state == STATE_CLOSED && header->schemaVersion == schemaVersion
+                && header->cacheBytes == sizeof(Cache) && header->capacity == MAX_SIZE
+                && header->keyBytes == sizeof(Key) && header->valueBytes == sizeof(Value);
+            if (restored) {
+                cache = std::launder(reinterpret_cast<Cache*>(base + CACHE_OFFSET));
+            } else {
+                cache = ::new (base + CACHE_OFFSET) Cache();
+                *header = Header{MAGIC, FORMAT_VERSION, STATE_OPEN, schemaVersion, sizeof(Cache), MAX_SIZE,
+                                 static_cast<uint32_t>(sizeof(Key)), static_cast<uint32_t>(sizeof(Value))};
+            }
+            // Until the clean close, a crash leaves the file marked open and it is discarded
+            header->state = STATE_OPEN;
+        } catch (...) {
+            release();
+            throw;
         }
-        
-        // Use next available slot in fixed array
-        Node* node = &nodePool[poolSize];
-        *node = Node(key, value, frequency);
-        poolSize++;
-        return node;
     }
     
-    // OPTIMIZATION: Force inlining of deallocation (hot path)
-    inline void deallocateNode(Node* node) {
-        // OPTIMIZATION: Pointer arithmetic optimization with explicit bounds
-        int idx = static_cast<int>(node - &nodePool[0]);
-        
-        // OPTIMIZATION: Template-based bounds checking for better optimization
-        if constexpr (MAX_SIZE > 0) {
-            assert(idx >= 0 && idx < static_cast<int>(MAX_SIZE) && "Invalid node pointer");
-            // OPTIMIZATION: Remove unreachable return after assert in release builds
+    PersistentLFUCache(const PersistentLFUCache&) = delete;
+    PersistentLFUCache& operator=(const PersistentLFUCache&) = delete;
+    
+    // Writes the cache back and marks the file clean; the cache itself is left in place
+    ~PersistentLFUCache() {
+        if (base) {
+            ::msync(base, FILE_BYTES, MS_SYNC);
+            headerPtr()->state = STATE_CLOSED;
+            ::msync(base, CACHE_OFFSET, MS_SYNC);
         }
-        
-        // Add to free list
-        freeNodes[freeCount] = idx;
-        ++freeCount;
+        release();
     }
     
-    // OPTIMIZATION: Force inlining of frequency update (most critical function)
-    inline void updateFrequency(Node* node) {
-        int oldFreq = node->frequency;
-        int newFreq = oldFreq + 1;
-        
-        // Remove from old frequency list
-        auto oldIt = frequencyToList.find(oldFreq);
-        if (oldIt != frequencyToList.end()) [[likely]] {
-            oldIt->second.Remove(node);
-            // Clean up empty frequency lists to prevent memory waste
-            if (oldIt->second.Empty()) [[unlikely]] {
-                frequencyToList.erase(oldIt);
-            }
+    // Flushes the mapping to the file without closing it (the file stays marked open)
+    void Flush() const noexcept {
+        ::msync(base, FILE_BYTES, MS_SYNC);
+    }
+    
+    // True if the entries of a previous run were resumed, false if the cache started empty
+    inline bool Restored() const noexcept { return restored; }
+    
+    inline Cache& operator*() noexcept { return *cache; }
+    inline const Cache& operator*() const noexcept { return *cache; }
+    inline Cache* operator->() noexcept { return cache; }
+    inline const Cache* operator->() const noexcept { return cache; }
+    
+private:
+    inline Header* headerPtr() const noexcept { return reinterpret_cast<Header*>(base); }
+    
+    void release() noexcept {
+        if (base) {
+            ::munmap(base, FILE_BYTES);
+            base = nullptr;
         }
-        
-        // Update frequency and add to new list
-        node->frequency = newFreq;
-        frequencyToList[newFreq].AddToHead(node);
-        
-        // OPTIMIZATION: Update minimum frequency
-        if (oldFreq == minFrequency && frequencyToList.find(minFrequency) == frequencyToList.end()) [[unlikely]] {
-            minFrequency++;
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
         }
     }
     
+    int fd = -1;
+    std::byte* base = nullptr;
+    Cache* cache = nullptr;
+    bool restored = false;
+};
+#endif
+
+// Thread-safe LFU cache: keys are partitioned by hash across SHARDS independent
+// LFUCache shards, each with its own lock and on its own cache lines, so threads
+// touching different shards never contend. Eviction is per shard (each holds
+// ceil(CAPACITY / SHARDS) entries), i.e. LFU order is approximate across shards.
+template<typename Key, typename Value, size_t CAPACITY, size_t SHARDS = 16, typename Hash = std::hash<Key>,
+         typename Admission = LFUAlwaysAdmit, typename KeyEqual = std::equal_to<Key>,
+         typename EvictionListener = LFUNoEvictionListener, typename Weigher = LFUUnitWeigher,
+         typename Expiry = LFUNoExpiry, typename Stats = LFUNoStats, typename Eviction = LFUEviction>
+class ShardedLFUCache {
 public:
-    LFUCache() 
-        : minFrequency(0), poolSize(0), freeCount(0) {
-        
-        // OPTIMIZATION: Template-based compile-time validation
-        static_assert(MAX_SIZE > 0, "MAX_SIZE must be positive");
+    static constexpr size_t SHARD_CAPACITY = (CAPACITY + SHARDS - 1) / SHARDS;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    
+    static_assert(SHARDS > 0 && std::has_single_bit(SHARDS), "SHARDS must be a power of two");
+    static_assert(CAPACITY >= SHARDS, "CAPACITY must provide at least one entry per shard");
+    
+    // Each shard has its own listener instance, called with that shard's lock held
+    using ShardCache = LFUCache<Key, Value, SHARD_CAPACITY, Hash, Admission, KeyEqual, EvictionListener, Weigher,
+                                Expiry, Stats, Eviction>;
+    
+    // One loader run in progress for a key; threads missing on the same key wait on it
+    struct InFlight {
+        explicit InFlight(const Key& k) : key(k) {}
         
-        // OPTIMIZATION: Reserve space for common frequencies to avoid rehashing
-        frequencyToList.reserve(std::max(MIN_FREQUENCY_SIZE, 
-                                        MAX_SIZE / INITIAL_SIZE_MULTIPLIER));
-    }
+        Key key;
+        std::condition_variable done;
+        std::optional<Value> value;
+        std::exception_ptr error;
+        bool finished = false;
+    };
     
-    // OPTIMIZATION: Hot path version - no exceptions for maximum performance
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::mutex mutex;
+        ShardCache cache;
+        std::vector<std::shared_ptr<InFlight>> inFlight;  // Few entries: scanned linearly
+    };
+    
+    ShardedLFUCache() = default;
+    ShardedLFUCache(const ShardedLFUCache&) = delete;
+    ShardedLFUCache& operator=(const ShardedLFUCache&) = delete;
+    
+    // The key is hashed once: the same Hash{}(key) picks the shard and indexes within it
     inline Value Get(const Key& key) noexcept {
-        auto it = keyToNode.find(key);
-        if (it == keyToNode.end()) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
-            return Value{};  // Return default-constructed value for missing keys
-        }
-        
-        Node* node = it->second;
-        updateFrequency(node);
-        return node->value;
+        return GetWithHash(key, hasher(key));
     }
     
-    // Exception-throwing version for when you need error handling
     inline Value GetOrThrow(const Key& key) {
-        auto it = keyToNode.find(key);
-        if (it == keyToNode.end()) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
-            throw std::runtime_error("Key not found");
-        }
-        
-        Node* node = it->second;
-        updateFrequency(node);
-        return node->value;
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.GetOrThrow(key);
     }
     
-    // OPTIMIZATION: Force inlining of getOrDefault function (hot path) - already noexcept
     inline Value GetOrDefault(const Key& key, const Value& defaultValue) noexcept {
-        auto it = keyToNode.find(key);
-        if (it == keyToNode.end()) [[unlikely]] {  // OPTIMIZATION: Branch prediction hint
-            return defaultValue;
-        }
-        
-        Node* node = it->second;
-        updateFrequency(node);
-        return node->value;
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.GetOrDefault(key, defaultValue);
     }
     
-    // OPTIMIZATION: Force inlining of contains function (hot path) - noexcept for performance
-    inline bool Contains(const Key& key) const noexcept {
-        return keyToNode.find(key) != keyToNode.end();
+    inline bool TryGet(const Key& key, Value& out) noexcept {
+        return TryGetWithHash(key, hasher(key), out);
     }
     
-    // OPTIMIZATION: Hot path put - noexcept for maximum performance
-    void Put(const Key& key, const Value& value) noexcept {
-        auto it = keyToNode.find(key);
-        if (it != keyToNode.end()) [[likely]] {  // OPTIMIZATION: Branch prediction hint - cache updates are common
-            // Update existing key
-            Node* node = it->second;
-            node->value = value;
-            updateFrequency(node);
-            return;
+    inline std::optional<Value> TryGet(const Key& key) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.TryGet(key);
+    }
+    
+    // Heterogeneous lookups (transparent Hash and KeyEqual only), see LFUCache
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline Value Get(const K& key) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.Get(key);
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline Value GetOrDefault(const K& key, const Value& defaultValue) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.GetOrDefault(key, defaultValue);
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline bool TryGet(const K& key, Value& out) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.TryGet(key, out);
+    }
+    
+    template<typename K> requires LFUTransparentLookup<Hash, KeyEqual>
+    inline bool Contains(const K& key) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.Contains(key);
+    }
+    
+    // Read-through access with single-flight loading: a hit returns under the shard lock;
+    // on a miss the first thread runs loader(key) without holding the lock while later
+    // threads missing on the same key wait for its result instead of loading again.
+    // A loader exception is rethrown in every waiting thread and nothing is cached.
+    // The loader may use this cache, but must not call GetOrCompute() for the same key.
+    template<typename Loader>
+    Value GetOrCompute(const Key& key, Loader&& loader) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        if (const Value* cached = shard.cache.Find(key)) [[likely]] {  // OPTIMIZATION: Branch prediction hint
+            return *cached;
         }
         
-        // Add new key - check capacity
-        if (keyToNode.size() >= MAX_SIZE) [[likely]] {  // OPTIMIZATION: Branch prediction hint
-            // Remove least frequently used item
-            auto minFreqIt = frequencyToList.find(minFrequency);
-            if (minFreqIt != frequencyToList.end() && !minFreqIt->second.Empty()) [[likely]] {
-                Node* lru = minFreqIt->second.tail;
-                minFreqIt->second.Remove(lru);
-                keyToNode.erase(lru->key);
-                deallocateNode(lru);
-                // Clean up empty frequency list
-                if (minFreqIt->second.Empty()) [[unlikely]] {
-                    frequencyToList.erase(minFreqIt);
+        for (const std::shared_ptr<InFlight>& pending : shard.inFlight) {
+            if (keyEqual(pending->key, key)) {
+                std::shared_ptr<InFlight> flight = pending;  // Outlives its removal from the list
+                flight->done.wait(lock, [&] { return flight->finished; });
+                if (flight->error) {
+                    std::rethrow_exception(flight->error);
                 }
+                return *flight->value;
             }
         }
         
-        // Add new node
-        Node* newNode = allocateNode(key, value, 1);
-        keyToNode[key] = newNode;
-
-        frequencyToList[1].AddToHead(newNode);
-        minFrequency = 1;
+        auto flight = std::make_shared<InFlight>(key);
+        shard.inFlight.push_back(flight);
+        lock.unlock();
+        try {
+            flight->value.emplace(loader(key));
+        } catch (...) {
+            flight->error = std::current_exception();
+        }
+        lock.lock();
+        
+        if (!flight->error) {
+            shard.cache.Put(key, *flight->value);
+        }
+        flight->finished = true;
+        std::erase(shard.inFlight, flight);
+        flight->done.notify_all();
+        if (flight->error) {
+            std::rethrow_exception(flight->error);
+        }
+        return *flight->value;
     }
     
-    // OPTIMIZATION: Force inlining of simple getters - noexcept for performance
-    inline int Size() const noexcept {
-        return static_cast<int>(keyToNode.size());
+    // Zero-copy access under the shard lock; Find() is not offered because the pointer
+    // would outlive the lock. fn must not call back into this cache.
+    template<typename Fn>
+    inline bool Visit(const Key& key, Fn&& fn) noexcept(noexcept(fn(std::declval<const Value&>()))) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.Visit(key, std::forward<Fn>(fn));
+    }
+    
+    inline bool Contains(const Key& key) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.Contains(key);
+    }
+    
+    inline void Put(const Key& key, const Value& value) noexcept {
+        PutWithHash(key, hasher(key), value);
+    }
+    
+    inline void Put(const Key& key, Value&& value) noexcept {
+        PutWithHash(key, hasher(key), std::move(value));
+    }
+    
+    // Precomputed-hash entry points; hash must be Hash{}(key), see LFUCache
+    inline Value GetWithHash(const Key& key, size_t hash) noexcept {
+        Shard& shard = shards[ShardIndexForHash(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.GetWithHash(key, hash);
+    }
+    
+    inline bool TryGetWithHash(const Key& key, size_t hash, Value& out) noexcept {
+        Shard& shard = shards[ShardIndexForHash(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.TryGetWithHash(key, hash, out);
+    }
+    
+    inline void PutWithHash(const Key& key, size_t hash, const Value& value) noexcept {
+        Shard& shard = shards[ShardIndexForHash(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.PutWithHash(key, hash, value);
+    }
+    
+    inline void PutWithHash(const Key& key, size_t hash, Value&& value) noexcept {
+        Shard& shard = shards[ShardIndexForHash(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.PutWithHash(key, hash, std::move(value));
+    }
+    
+    // The value is constructed under the shard lock, directly in the shard's pool slot
+    template<typename... Args>
+    inline bool Emplace(const Key& key, Args&&... args) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.Emplace(key, std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    inline bool TryEmplace(const Key& key, Args&&... args) noexcept {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.TryEmplace(key, std::forward<Args>(args)...);
+    }
+    
+    // Sum over shards; each shard is locked in turn, so the total is not a global snapshot
+    int Size() noexcept {
+        int total = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.cache.Size();
+        }
+        return total;
     }
     
     inline constexpr size_t Capacity() const noexcept {
-        return MAX_SIZE;
+        return SHARD_CAPACITY * SHARDS;
     }
     
     void Clear() noexcept {
-        keyToNode.clear();
-        frequencyToList.clear();
-        
-        // OPTIMIZATION: Loop optimization - use standard algorithm instead of manual loop
-        if (poolSize > 0) {
-            std::iota(freeNodes.begin(), freeNodes.begin() + poolSize, 0);
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.Clear();
         }
-        freeCount = poolSize;
-        poolSize = 0;
-        minFrequency = 0;
     }
     
-    // Debug function with optimization hints
-    void PrintState() const {
-        std::cout << "Cache State (size=" << Size() << ", capacity=" << MAX_SIZE << "):\n";
-        for (const auto& [freq, list] : frequencyToList) {
-            if (!list.Empty()) {
-                std::cout << "  Freq " << freq << ": ";
-                Node* current = list.head;
-                while (current) [[likely]] {  // OPTIMIZATION: Branch prediction hint
-                    std::cout << "(" << current->key << "," << current->value << ") ";
-                    current = current->next;
-                }
-                std::cout << "\n";
-            }
+    template<typename Rep, typename Period>
+    void SetDefaultTTL(std::chrono::duration<Rep, Period> ttl) noexcept requires Expiry::ENABLED {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.SetDefaultTTL(ttl);
+        }
+    }
+    
+    template<typename Rep, typename Period>
+    inline void PutWithTTL(const Key& key, const Value& value, std::chrono::duration<Rep, Period> ttl) noexcept
+        requires Expiry::ENABLED {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.PutWithTTL(key, value, ttl);
+    }
+    
+    size_t PurgeExpired() noexcept requires Expiry::ENABLED {
+        size_t purged = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            purged += shard.cache.PurgeExpired();
+        }
+        return purged;
+    }
+    
+    // Counters summed over shards, each locked in turn while its counters are copied
+    LFUCacheStats Statistics() noexcept requires Stats::ENABLED {
+        LFUCacheStats total;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.cache.Statistics();
+        }
+        return total;
+    }
+    
+    void ResetStatistics() noexcept requires Stats::ENABLED {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.ResetStatistics();
+        }
+    }
+    
+    // Per-shard histograms merged into one, each shard locked in turn
+    LFULatencyHistogram Latency(LFUOperation operation) noexcept requires Stats::TIMED {
+        LFULatencyHistogram merged;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            merged.Merge(shard.cache.Latency(operation));
+        }
+        return merged;
+    }
+    
+    // Sum over shards, each locked in turn (weighted caches)
+    size_t Weight() noexcept requires Weigher::ENABLED {
+        size_t total = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.cache.Weight();
+        }
+        return total;
+    }
+    
+    // Splits the budget evenly: each shard holds at most budget / SHARDS
+    void SetMaxWeight(size_t budget) noexcept requires Weigher::ENABLED {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.SetMaxWeight(budget / SHARDS);
+        }
+    }
+    
+    // Calls fn(listener) for every shard's eviction listener, under that shard's lock
+    template<typename Fn>
+    void ForEachListener(Fn&& fn) {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            fn(shard.cache.Listener());
+        }
+    }
+    
+    // Applies to every shard; each shard ages independently from its own evictions
+    void SetDynamicAging(bool enabled) noexcept requires (!Eviction::ENABLED) {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.SetDynamicAging(enabled);
+        }
+    }
+    
+    // Fibonacci hashing on the top bits, independent of the bits each shard indexes by.
+    // K is Key, or any type accepted by a transparent Hash.
+    template<typename K>
+    inline size_t ShardIndex(const K& key) const noexcept {
+        return ShardIndexForHash(hasher(key));
+    }
+    
+    // Shard of a key from its Hash{}(key), as passed to the *WithHash entry points
+    static inline size_t ShardIndexForHash(size_t hash) noexcept {
+        if constexpr (SHARDS == 1) {
+            return 0;
+        } else {
+            uint64_t h = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+            return static_cast<size_t>(h >> (64 - std::countr_zero(SHARDS)));
         }
-        std::cout << "  Min frequency: " << minFrequency << "\n";
     }
+    
+private:
+    template<typename K>
+    inline Shard& shardFor(const K& key) noexcept {
+        return shards[ShardIndex(key)];
+    }
+    
+    std::array<Shard, SHARDS> shards;
+    Hash hasher;
+    KeyEqual keyEqual;
 };
 
 #endif // LFU_CACHE_H
\ No newline at end of file